@@ -0,0 +1,327 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_BenchmarkCommandlet.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_PropulsionSubsystem.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_Utils.h"
+#include "SGSM_LogCategory.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+namespace SGSM_Benchmark
+{
+	// Ships are laid out on a grid far enough apart to never collide.
+	static constexpr double ShipSpacing = 10000.0;
+
+	static uint64 GetAllocationCalls()
+	{
+#if !UE_BUILD_SHIPPING
+		return FMalloc::TotalMallocCalls.load(std::memory_order_relaxed) + FMalloc::TotalReallocCalls.load(std::memory_order_relaxed);
+#else
+		return 0;
+#endif
+	}
+}
+
+USGSM_BenchmarkCommandlet::USGSM_BenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = true;
+	LogToConsole = true;
+}
+
+int32 USGSM_BenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace SGSM_Benchmark;
+
+	FString ShipCountsParam = TEXT("1,10,100,1000,5000");
+	FParse::Value(*Params, TEXT("Ships="), ShipCountsParam);
+
+	TArray<FString> ShipCountStrings;
+	ShipCountsParam.ParseIntoArray(ShipCountStrings, TEXT(","));
+	for (const FString& ShipCountString : ShipCountStrings)
+	{
+		ShipCounts.Add(FMath::Max(1, FCString::Atoi(*ShipCountString)));
+	}
+
+	FParse::Value(*Params, TEXT("Steps="), NumSteps);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmupSteps);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	NumSteps = FMath::Max(NumSteps, 1);
+	NumWarmupSteps = FMath::Max(NumWarmupSteps, 0);
+	DeltaTime = FMath::Max(DeltaTime, UE_KINDA_SMALL_NUMBER);
+
+	FString PatternParam;
+	if (FParse::Value(*Params, TEXT("Pattern="), PatternParam))
+	{
+		if (PatternParam == TEXT("Thrust")) Pattern = EInputPattern::Thrust;
+		else if (PatternParam == TEXT("Boost")) Pattern = EInputPattern::Boost;
+		else if (PatternParam == TEXT("Brake")) Pattern = EInputPattern::Brake;
+		else if (PatternParam == TEXT("AltTurn")) Pattern = EInputPattern::AltTurn;
+	}
+
+	FString TracePath;
+	if (FParse::Value(*Params, TEXT("Trace="), TracePath))
+	{
+		if (!Trace.LoadFromFile(TracePath))
+		{
+			return 1;
+		}
+		bUseTrace = true;
+		UE_LOG(SMLogGeneric, Display, TEXT("Replaying input trace \"%s\" of %d ships and %d frames"), *TracePath, Trace.GetNumShips(), Trace.NumFrames);
+	}
+
+	FString ShipClassPath = SGSM_Utils::DemoShipClassPath;
+	FParse::Value(*Params, TEXT("ShipClass="), ShipClassPath);
+
+	UClass* const ShipClass = LoadClass<APawn>(nullptr, *ShipClassPath);
+	if (!ShipClass)
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("Failed to load ship class \"%s\", pass a pawn class with a propulsion brain as -ShipClass=<Path>"), *ShipClassPath);
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("SGSM_Benchmark_%s.csv"), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	FString Csv = TEXT("Ships,Steps,PropulsionStepMeanMs,PropulsionStepP99Ms,GameThreadMeanMs,GameThreadP99Ms,AllocationsPerFrame,UsedMemoryDeltaMB\n");
+
+	for (const int32 NumShips : ShipCounts)
+	{
+		FRunResult Result;
+		if (!RunPass(ShipClass, NumShips, Result))
+		{
+			return 1;
+		}
+
+		const FString Row = FString::Printf(TEXT("%d,%d,%.4f,%.4f,%.4f,%.4f,%.1f,%.2f"),
+			Result.NumShips, Result.NumSteps,
+			Result.PropulsionStepMeanMs, Result.PropulsionStepP99Ms,
+			Result.GameThreadMeanMs, Result.GameThreadP99Ms,
+			Result.AllocationsPerFrame, Result.UsedMemoryDeltaMB);
+
+		UE_LOG(SMLogGeneric, Display, TEXT("%s"), *Row);
+		Csv += Row + TEXT("\n");
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("Failed to write benchmark results to \"%s\""), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(SMLogGeneric, Display, TEXT("Wrote benchmark results to \"%s\""), *OutputPath);
+	return 0;
+}
+
+UWorld* USGSM_BenchmarkCommandlet::CreateBenchmarkWorld()
+{
+	UWorld* const World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SGSM_Benchmark"));
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+
+	// There is no game mode, so begin play is dispatched directly. Ships spawned from now on begin play as they spawn.
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	return World;
+}
+
+void USGSM_BenchmarkCommandlet::DestroyBenchmarkWorld(UWorld* InWorld)
+{
+	GEngine->DestroyWorldContext(InWorld);
+	InWorld->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+bool USGSM_BenchmarkCommandlet::RunPass(UClass* InShipClass, int32 InNumShips, FRunResult& OutResult) const
+{
+	using namespace SGSM_Benchmark;
+
+	UWorld* const World = CreateBenchmarkWorld();
+
+	USGSM_PropulsionSubsystem* const PropulsionSubsystem = USGSM_PropulsionSubsystem::Get(World);
+	if (!ensureAlwaysMsgf(PropulsionSubsystem, TEXT("Failed to get Propulsion Subsystem")))
+	{
+		DestroyBenchmarkWorld(World);
+		return false;
+	}
+
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<double>(InNumShips)));
+
+	TArray<USGSM_PropulsionBrain*> Ships;
+	Ships.Reserve(InNumShips);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 ShipIndex = 0; ShipIndex < InNumShips; ++ShipIndex)
+	{
+		const FVector Location((ShipIndex % GridSize) * ShipSpacing, (ShipIndex / GridSize) * ShipSpacing, 0.0);
+		const APawn* const Ship = World->SpawnActor<APawn>(InShipClass, Location, FRotator::ZeroRotator, SpawnParameters);
+		if (USGSM_PropulsionBrain* const PropulsionBrain = Ship ? Ship->FindComponentByClass<USGSM_PropulsionBrain>() : nullptr)
+		{
+			Ships.Add(PropulsionBrain);
+		}
+	}
+
+	UE_CLOG(Ships.Num() != InNumShips, SMLogGeneric, Warning, TEXT("Spawned %d of %d ships with a propulsion brain"), Ships.Num(), InNumShips);
+
+	TArray<double> GameThreadTimes;
+	TArray<double> PropulsionStepTimes;
+	GameThreadTimes.Reserve(NumSteps);
+
+	FSGSM_InputTracePlayer TracePlayer;
+	TracePlayer.Reset(&Trace, Ships.Num());
+
+	uint64 AllocationCalls = 0;
+	const uint64 UsedMemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	for (int32 Step = -NumWarmupSteps; Step < NumSteps; ++Step)
+	{
+		const bool bMeasure = Step >= 0;
+		if (Step == 0)
+		{
+			PropulsionSubsystem->SetCaptureStepTimings(true);
+		}
+
+		const uint64 AllocationCallsBefore = GetAllocationCalls();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		if (bUseTrace)
+		{
+			// Warmup replays the start of the trace as well.
+			TracePlayer.Advance(Step + NumWarmupSteps, true);
+			for (int32 ShipIndex = 0; ShipIndex < Ships.Num(); ++ShipIndex)
+			{
+				Ships[ShipIndex]->ApplyPilotInput(TracePlayer.GetInput(ShipIndex));
+			}
+		}
+		else
+		{
+			for (int32 ShipIndex = 0; ShipIndex < Ships.Num(); ++ShipIndex)
+			{
+				DriveShip(Ships[ShipIndex], ShipIndex, Step);
+			}
+		}
+
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+
+		if (bMeasure)
+		{
+			GameThreadTimes.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+			AllocationCalls += GetAllocationCalls() - AllocationCallsBefore;
+		}
+	}
+
+	PropulsionSubsystem->SetCaptureStepTimings(false);
+	PropulsionSubsystem->DrainStepTimings(PropulsionStepTimes);
+	for (double& StepTime : PropulsionStepTimes)
+	{
+		StepTime *= 1000.0;
+	}
+
+	OutResult.NumShips = Ships.Num();
+	OutResult.NumSteps = NumSteps;
+	OutResult.PropulsionStepMeanMs = GetMean(PropulsionStepTimes);
+	OutResult.PropulsionStepP99Ms = GetPercentile(PropulsionStepTimes, 0.99);
+	OutResult.GameThreadMeanMs = GetMean(GameThreadTimes);
+	OutResult.GameThreadP99Ms = GetPercentile(GameThreadTimes, 0.99);
+	OutResult.AllocationsPerFrame = static_cast<double>(AllocationCalls) / NumSteps;
+	OutResult.UsedMemoryDeltaMB = (static_cast<double>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<double>(UsedMemoryBefore)) / (1024.0 * 1024.0);
+
+	DestroyBenchmarkWorld(World);
+	return true;
+}
+
+void USGSM_BenchmarkCommandlet::DriveShip(USGSM_PropulsionBrain* InPropulsionBrain, int32 InShipIndex, int32 InStep) const
+{
+	EInputPattern ShipPattern = Pattern;
+	if (ShipPattern == EInputPattern::Mixed)
+	{
+		ShipPattern = static_cast<EInputPattern>(1 + InShipIndex % 4);
+	}
+
+	// Every ship runs its own phase of a two second cycle so the fleet never switches in lockstep.
+	const double Time = (InStep + InShipIndex * 7) * DeltaTime;
+	const double CyclePhase = FMath::Fmod(Time, 2.0) / 2.0;
+
+	FSGSM_PilotInput PilotInput;
+
+	switch (ShipPattern)
+	{
+	case EInputPattern::Thrust:
+		PilotInput.LinearThrust = FVector2D(FMath::Cos(Time), FMath::Sin(Time));
+		PilotInput.AngularThrust = FVector2D(FMath::Sin(Time * 0.5), 0.0);
+		break;
+
+	case EInputPattern::Boost:
+		PilotInput.LinearThrust = FVector2D(1.0, 0.0);
+		PilotInput.bBoosting = CyclePhase < 0.5;
+		PilotInput.BoostValue = 1.f;
+		break;
+
+	case EInputPattern::Brake:
+		// Accelerate, then coast into both brakes.
+		PilotInput.LinearThrust = CyclePhase < 0.5 ? FVector2D(1.0, 0.0) : FVector2D::ZeroVector;
+		PilotInput.AngularThrust = CyclePhase < 0.5 ? FVector2D(1.0, 0.0) : FVector2D::ZeroVector;
+		PilotInput.bLinearBrake = CyclePhase >= 0.5;
+		PilotInput.bAngularBrake = CyclePhase >= 0.5;
+		break;
+
+	case EInputPattern::AltTurn:
+	{
+		// Chase a target orbiting the ship, the alternative turning input is the target direction rotated a quarter turn.
+		const FVector TargetDirection(FMath::Cos(Time * 1.5), FMath::Sin(Time * 1.5), 0.0);
+		PilotInput.bAlternativeTurning = true;
+		PilotInput.AngularThrust = FVector2D(TargetDirection.Y, -TargetDirection.X);
+		PilotInput.LinearThrust = FVector2D(1.0, 0.0);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	InPropulsionBrain->ApplyPilotInput(PilotInput);
+}
+
+double USGSM_BenchmarkCommandlet::GetMean(const TArray<double>& InSamples)
+{
+	if (InSamples.IsEmpty())
+	{
+		return 0.0;
+	}
+
+	double Sum = 0.0;
+	for (const double Sample : InSamples)
+	{
+		Sum += Sample;
+	}
+	return Sum / InSamples.Num();
+}
+
+double USGSM_BenchmarkCommandlet::GetPercentile(TArray<double> InSamples, double InPercentile)
+{
+	if (InSamples.IsEmpty())
+	{
+		return 0.0;
+	}
+
+	InSamples.Sort();
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(InPercentile * InSamples.Num()) - 1, 0, InSamples.Num() - 1);
+	return InSamples[Index];
+}
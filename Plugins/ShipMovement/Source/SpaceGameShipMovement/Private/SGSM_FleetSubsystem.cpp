@@ -0,0 +1,321 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_FleetSubsystem.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_Stats.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+
+static int32 GSGSM_FleetParallelShipThreshold = 128;
+static FAutoConsoleVariableRef CVarSGSM_FleetParallelShipThreshold(
+	TEXT("sgsm.Fleet.ParallelShipThreshold"),
+	GSGSM_FleetParallelShipThreshold,
+	TEXT("Number of fleet ships at which fleet steering is split across worker threads."),
+	ECVF_Default);
+
+USGSM_FleetSubsystem* USGSM_FleetSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? World->GetSubsystem<USGSM_FleetSubsystem>() : nullptr;
+}
+
+bool USGSM_FleetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId USGSM_FleetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGSM_FleetSubsystem, STATGROUP_Tickables);
+}
+
+FSGSM_FleetHandle USGSM_FleetSubsystem::CreateFleet(const FSGSM_FleetSteeringSettings& InSettings)
+{
+	FFleet Fleet;
+	Fleet.Settings = InSettings;
+
+	FSGSM_FleetHandle Handle;
+	Handle.Id = Fleets.Add(MoveTemp(Fleet));
+	return Handle;
+}
+
+void USGSM_FleetSubsystem::DestroyFleet(FSGSM_FleetHandle& InOutFleet)
+{
+	if (!FindFleet(InOutFleet))
+	{
+		return;
+	}
+
+	for (int32 ShipIndex = Ships.Num() - 1; ShipIndex >= 0; --ShipIndex)
+	{
+		if (Ships[ShipIndex].FleetId == InOutFleet.Id)
+		{
+			if (USGSM_PropulsionBrain* const Brain = Ships[ShipIndex].Brain.Get())
+			{
+				Brain->ApplyPilotInput(FSGSM_PilotInput());
+			}
+			RemoveShipAt(ShipIndex);
+		}
+	}
+
+	Fleets.RemoveAt(InOutFleet.Id);
+	InOutFleet.Reset();
+}
+
+USGSM_FleetSubsystem::FFleet* USGSM_FleetSubsystem::FindFleet(FSGSM_FleetHandle InFleet)
+{
+	return InFleet.IsValid() && Fleets.IsValidIndex(InFleet.Id) ? &Fleets[InFleet.Id] : nullptr;
+}
+
+void USGSM_FleetSubsystem::SetFleetSettings(FSGSM_FleetHandle InFleet, const FSGSM_FleetSteeringSettings& InSettings)
+{
+	if (FFleet* const Fleet = FindFleet(InFleet))
+	{
+		Fleet->Settings = InSettings;
+	}
+}
+
+void USGSM_FleetSubsystem::SetFormation(FSGSM_FleetHandle InFleet, TConstArrayView<FVector> InSlotOffsets)
+{
+	if (FFleet* const Fleet = FindFleet(InFleet))
+	{
+		Fleet->SlotOffsets = InSlotOffsets;
+	}
+}
+
+void USGSM_FleetSubsystem::SetFormationAnchor(FSGSM_FleetHandle InFleet, const FTransform& InAnchor, const FVector& InAnchorVelocity)
+{
+	if (FFleet* const Fleet = FindFleet(InFleet))
+	{
+		Fleet->Anchor = InAnchor;
+		Fleet->AnchorVelocity = InAnchorVelocity;
+		Fleet->bHasAnchor = true;
+	}
+}
+
+void USGSM_FleetSubsystem::AddShip(FSGSM_FleetHandle InFleet, USGSM_PropulsionBrain* InBrain, int32 InSlotIndex)
+{
+	if (!ensureAlwaysMsgf(InBrain && FindFleet(InFleet), TEXT("Fleet ships need a brain and a valid fleet")))
+	{
+		return;
+	}
+
+	if (const int32* const ExistingIndex = ShipIndices.Find(InBrain))
+	{
+		Ships[*ExistingIndex].FleetId = InFleet.Id;
+		Ships[*ExistingIndex].SlotIndex = InSlotIndex;
+		return;
+	}
+
+	FFleetShip& Ship = Ships.AddDefaulted_GetRef();
+	Ship.Brain = InBrain;
+	Ship.Key = InBrain;
+	Ship.FleetId = InFleet.Id;
+	Ship.SlotIndex = InSlotIndex;
+
+	ShipIndices.Add(InBrain, Ships.Num() - 1);
+}
+
+void USGSM_FleetSubsystem::RemoveShip(USGSM_PropulsionBrain* InBrain)
+{
+	const int32* const ShipIndex = ShipIndices.Find(InBrain);
+	if (!ShipIndex)
+	{
+		return;
+	}
+
+	RemoveShipAt(*ShipIndex);
+	InBrain->ApplyPilotInput(FSGSM_PilotInput());
+}
+
+void USGSM_FleetSubsystem::RemoveShipAt(int32 InShipIndex)
+{
+	ShipIndices.Remove(Ships[InShipIndex].Key);
+	Ships.RemoveAtSwap(InShipIndex, 1, EAllowShrinking::No);
+
+	if (Ships.IsValidIndex(InShipIndex))
+	{
+		ShipIndices.Add(Ships[InShipIndex].Key, InShipIndex);
+	}
+}
+
+void USGSM_FleetSubsystem::GatherSamples()
+{
+	Samples.Reset(Ships.Num());
+	SampleLocations.Reset(Ships.Num());
+
+	for (int32 ShipIndex = 0; ShipIndex < Ships.Num();)
+	{
+		const FFleetShip& Ship = Ships[ShipIndex];
+		const USGSM_PropulsionBrain* const Brain = Ship.Brain.Get();
+		const AActor* const Owner = Brain ? Brain->GetOwner() : nullptr;
+
+		if (!Owner)
+		{
+			// The last ship is swapped in, look at this index again.
+			RemoveShipAt(ShipIndex);
+			continue;
+		}
+
+		FShipSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.Location = Owner->GetActorLocation();
+		Sample.Velocity = Owner->GetVelocity();
+		Sample.Forward = Owner->GetActorForwardVector();
+		Sample.FleetId = Ship.FleetId;
+		Sample.SlotIndex = Ship.SlotIndex;
+
+		SampleLocations.Add(Sample.Location);
+		++ShipIndex;
+	}
+}
+
+void USGSM_FleetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_FleetSteering);
+
+	GatherSamples();
+
+	SET_DWORD_STAT(STAT_SGSM_FleetShips, Samples.Num());
+
+	if (Samples.IsEmpty())
+	{
+		return;
+	}
+
+	double QueryRadius = 1.0;
+	for (const FFleet& Fleet : Fleets)
+	{
+		QueryRadius = FMath::Max3(QueryRadius, static_cast<double>(Fleet.Settings.NeighborRadius), static_cast<double>(Fleet.Settings.SeparationRadius));
+	}
+
+	SpatialHash.Build(SampleLocations, QueryRadius);
+
+	Outputs.SetNum(Samples.Num(), EAllowShrinking::No);
+
+	const EParallelForFlags ParallelForFlags = Samples.Num() >= GSGSM_FleetParallelShipThreshold ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	ParallelFor(Samples.Num(), [this](int32 ShipIndex)
+	{
+		Outputs[ShipIndex] = ComputeSteering(ShipIndex);
+	}, ParallelForFlags);
+
+	// Brains are UObjects, the result is applied back on the game thread.
+	for (int32 ShipIndex = 0; ShipIndex < Samples.Num(); ++ShipIndex)
+	{
+		if (USGSM_PropulsionBrain* const Brain = Ships[ShipIndex].Brain.Get())
+		{
+			Brain->ApplyPilotInput(Outputs[ShipIndex]);
+		}
+	}
+}
+
+FSGSM_PilotInput USGSM_FleetSubsystem::ComputeSteering(int32 InShipIndex) const
+{
+	const FShipSample& Self = Samples[InShipIndex];
+	const FFleet& Fleet = Fleets[Self.FleetId];
+	const FSGSM_FleetSteeringSettings& Settings = Fleet.Settings;
+
+	const double CruiseSpeed = FMath::Max(Settings.CruiseSpeed, 1.f);
+	const double NeighborRadiusSquared = FMath::Square(static_cast<double>(Settings.NeighborRadius));
+	const double SeparationRadius = FMath::Max(Settings.SeparationRadius, 1.f);
+
+	FVector Separation = FVector::ZeroVector;
+	FVector VelocitySum = FVector::ZeroVector;
+	FVector LocationSum = FVector::ZeroVector;
+	int32 NumMates = 0;
+	int32 NumVisited = 0;
+
+	SpatialHash.Query(Self.Location, FMath::Max(static_cast<double>(Settings.NeighborRadius), SeparationRadius), [&](int32 OtherIndex, double DistanceSquared)
+	{
+		if (OtherIndex == InShipIndex)
+		{
+			return true;
+		}
+
+		const FShipSample& Other = Samples[OtherIndex];
+
+		// Stronger the closer the other ship is, any fleet.
+		const double Distance = FMath::Sqrt(DistanceSquared);
+		if (Distance < SeparationRadius)
+		{
+			const FVector Away = Distance > UE_KINDA_SMALL_NUMBER ? (Self.Location - Other.Location) / Distance : FVector::ForwardVector;
+			Separation += FVector(Away.X, Away.Y, 0.0) * (1.0 - Distance / SeparationRadius);
+		}
+
+		if (Other.FleetId == Self.FleetId && DistanceSquared < NeighborRadiusSquared)
+		{
+			VelocitySum += Other.Velocity;
+			LocationSum += Other.Location;
+			++NumMates;
+		}
+
+		return ++NumVisited < Settings.MaxNeighbors;
+	});
+
+	FVector DesiredVelocity = Separation * (CruiseSpeed * Settings.SeparationWeight);
+
+	if (NumMates > 0)
+	{
+		DesiredVelocity += VelocitySum / NumMates * Settings.AlignmentWeight;
+
+		const FVector ToCenter = (LocationSum / NumMates - Self.Location).GetSafeNormal2D();
+		DesiredVelocity += ToCenter * (CruiseSpeed * Settings.CohesionWeight);
+	}
+
+	FSGSM_PilotInput Input;
+	TOptional<FVector> Heading;
+
+	if (Fleet.bHasAnchor && Fleet.SlotOffsets.IsValidIndex(Self.SlotIndex))
+	{
+		const FVector SlotLocation = Fleet.Anchor.TransformPosition(Fleet.SlotOffsets[Self.SlotIndex]);
+		const FVector ToSlot = FVector(SlotLocation.X - Self.Location.X, SlotLocation.Y - Self.Location.Y, 0.0);
+		const double SlotDistance = ToSlot.Size();
+
+		// Resting in the slot, hold position with the brakes rather than dithering the thrusters.
+		if (SlotDistance < Settings.SlotBrakeDistance && Fleet.AnchorVelocity.IsNearlyZero() && Separation.IsNearlyZero())
+		{
+			Input.bLinearBrake = true;
+			Input.bAngularBrake = true;
+			return Input;
+		}
+
+		const double ArriveSpeed = CruiseSpeed * FMath::Min(1.0, SlotDistance / FMath::Max(Settings.SlotArriveDistance, 1.f));
+		DesiredVelocity += (ToSlot.GetSafeNormal() * ArriveSpeed + Fleet.AnchorVelocity) * Settings.FormationWeight;
+
+		// Close to the slot ships line up with the formation instead of their velocity.
+		if (SlotDistance < Settings.SlotArriveDistance)
+		{
+			Heading = Fleet.Anchor.GetUnitAxis(EAxis::X);
+		}
+	}
+
+	DesiredVelocity.Z = 0.0;
+	DesiredVelocity = DesiredVelocity.GetClampedToMaxSize(CruiseSpeed);
+
+	const FVector Steering = DesiredVelocity - FVector(Self.Velocity.X, Self.Velocity.Y, 0.0);
+	const FVector Thrust = (Steering / CruiseSpeed).GetClampedToMaxSize(1.0);
+	Input.LinearThrust = FVector2D(Thrust.X, Thrust.Y);
+
+	if (!Heading.IsSet() && DesiredVelocity.SizeSquared() > FMath::Square(0.1 * CruiseSpeed))
+	{
+		Heading = DesiredVelocity.GetSafeNormal();
+	}
+
+	// Alternative turning steers for a heading, its input is the heading rotated a quarter turn.
+	if (Heading.IsSet())
+	{
+		Input.bAlternativeTurning = true;
+		Input.AngularThrust = FVector2D(Heading->Y, -Heading->X);
+	}
+	else
+	{
+		Input.bAngularBrake = true;
+	}
+
+	return Input;
+}
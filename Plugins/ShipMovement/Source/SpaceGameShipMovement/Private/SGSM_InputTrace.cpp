@@ -0,0 +1,177 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_InputTrace.h"
+#include "SGSM_LogCategory.h"
+#include "HAL/FileManager.h"
+
+
+void FSGSM_InputTrace::Serialize(FArchive& Ar)
+{
+	uint32 FileMagic = Magic;
+	uint16 FileVersion = Version;
+	Ar << FileMagic << FileVersion;
+
+	if (Ar.IsLoading() && (FileMagic != Magic || FileVersion != Version))
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("Not an input trace, or an unsupported version (%u)"), FileVersion);
+		Ar.SetError();
+		return;
+	}
+
+	Ar << NumFrames << AverageDeltaTime;
+
+	// Same layout as serializing the array directly, the count is checked before anything is allocated for it.
+	int32 NumShipNames = ShipNames.Num();
+	Ar << NumShipNames;
+
+	if (Ar.IsLoading())
+	{
+		// Every name takes at least the length prefix of its string.
+		constexpr int64 MinShipNameSize = sizeof(int32);
+		const int64 RemainingSize = Ar.TotalSize() - Ar.Tell();
+		if (Ar.IsError() || NumShipNames < 0 || (Ar.TotalSize() >= 0 && NumShipNames > RemainingSize / MinShipNameSize))
+		{
+			UE_LOG(SMLogGeneric, Error, TEXT("Input trace claims %d ships, more than the file holds"), NumShipNames);
+			Ar.SetError();
+			return;
+		}
+
+		ShipNames.SetNum(NumShipNames);
+	}
+
+	for (FString& ShipName : ShipNames)
+	{
+		Ar << ShipName;
+	}
+
+	if (Ar.IsError())
+	{
+		return;
+	}
+
+	uint32 NumRecords = Records.Num();
+	Ar.SerializeIntPacked(NumRecords);
+
+	if (Ar.IsLoading())
+	{
+		// Every record takes at least a byte per packed index plus the input bytes, a larger count is a corrupt file.
+		constexpr int64 MinRecordSize = 2 + 6;
+		const int64 RemainingSize = Ar.TotalSize() - Ar.Tell();
+		if (Ar.IsError() || (Ar.TotalSize() >= 0 && NumRecords > RemainingSize / MinRecordSize))
+		{
+			UE_LOG(SMLogGeneric, Error, TEXT("Input trace claims %u changes, more than the file holds"), NumRecords);
+			Ar.SetError();
+			return;
+		}
+
+		Records.SetNum(NumRecords);
+	}
+
+	int32 PreviousFrame = 0;
+	for (FSGSM_InputTraceRecord& Record : Records)
+	{
+		uint32 FrameDelta = Record.Frame - PreviousFrame;
+		uint32 Ship = Record.Ship;
+		Ar.SerializeIntPacked(FrameDelta);
+		Ar.SerializeIntPacked(Ship);
+
+		FSGSM_QuantizedPilotInput& Input = Record.Input;
+		Ar << Input.LinearX << Input.LinearY << Input.AngularX << Input.AngularY << Input.Boost << Input.Flags;
+
+		if (Ar.IsLoading())
+		{
+			if (Ar.IsError() || Ship >= static_cast<uint32>(ShipNames.Num()))
+			{
+				UE_LOG(SMLogGeneric, Error, TEXT("Input trace change for ship %u, only %d ships were recorded"), Ship, ShipNames.Num());
+				Ar.SetError();
+				return;
+			}
+
+			Record.Frame = PreviousFrame + FrameDelta;
+			Record.Ship = Ship;
+		}
+
+		PreviousFrame = Record.Frame;
+	}
+}
+
+bool FSGSM_InputTrace::SaveToFile(const FString& InFilename)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*InFilename));
+	if (!Writer)
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("Failed to open \"%s\" for writing"), *InFilename);
+		return false;
+	}
+
+	Serialize(*Writer);
+	return Writer->Close();
+}
+
+bool FSGSM_InputTrace::LoadFromFile(const FString& InFilename)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*InFilename));
+	if (!Reader)
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("Failed to open input trace \"%s\""), *InFilename);
+		return false;
+	}
+
+	Serialize(*Reader);
+	return !Reader->IsError();
+}
+
+void FSGSM_InputTracePlayer::Reset(const FSGSM_InputTrace* InTrace, int32 InNumShips)
+{
+	Trace = InTrace;
+	NumShips = InNumShips;
+	NextRecord = 0;
+	LoopStartFrame = 0;
+	CurrentFrame = 0;
+
+	RecordedInputs.Reset();
+	RecordedInputs.SetNum(Trace ? Trace->GetNumShips() : 0);
+}
+
+void FSGSM_InputTracePlayer::Advance(int32 InFrame, bool bInLoop)
+{
+	CurrentFrame = InFrame;
+
+	if (!Trace || Trace->Records.IsEmpty())
+	{
+		return;
+	}
+
+	while (true)
+	{
+		while (Trace->Records.IsValidIndex(NextRecord) && LoopStartFrame + Trace->Records[NextRecord].Frame <= CurrentFrame)
+		{
+			const FSGSM_InputTraceRecord& Record = Trace->Records[NextRecord];
+			RecordedInputs[Record.Ship] = Record.Input.Dequantize();
+			++NextRecord;
+		}
+
+		if (!bInLoop || Trace->Records.IsValidIndex(NextRecord) || CurrentFrame < LoopStartFrame + Trace->NumFrames)
+		{
+			return;
+		}
+
+		// Start over with idle ships, the way the recording started.
+		LoopStartFrame += FMath::Max(Trace->NumFrames, 1);
+		NextRecord = 0;
+		for (FSGSM_PilotInput& Input : RecordedInputs)
+		{
+			Input = FSGSM_PilotInput();
+		}
+	}
+}
+
+FSGSM_PilotInput FSGSM_InputTracePlayer::GetInput(int32 InShip) const
+{
+	return RecordedInputs.IsValidIndex(InShip) ? RecordedInputs[InShip] : FSGSM_PilotInput();
+}
+
+bool FSGSM_InputTracePlayer::IsFinished() const
+{
+	return !Trace || CurrentFrame >= LoopStartFrame + Trace->NumFrames;
+}
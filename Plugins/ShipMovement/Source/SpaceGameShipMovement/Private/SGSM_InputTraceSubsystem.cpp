@@ -0,0 +1,415 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_InputTraceSubsystem.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_LogCategory.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+
+USGSM_InputTraceSubsystem* USGSM_InputTraceSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? World->GetSubsystem<USGSM_InputTraceSubsystem>() : nullptr;
+}
+
+void USGSM_InputTraceSubsystem::Deinitialize()
+{
+	if (bRecording)
+	{
+		UE_LOG(SMLogGeneric, Warning, TEXT("World torn down while recording an input trace, saving it"));
+		StopRecording(FString());
+	}
+
+	StopReplay();
+
+	Super::Deinitialize();
+}
+
+bool USGSM_InputTraceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId USGSM_InputTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGSM_InputTraceSubsystem, STATGROUP_Tickables);
+}
+
+FString USGSM_InputTraceSubsystem::GetDefaultTraceDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputTraces");
+}
+
+void USGSM_InputTraceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	SampleDirtyBrains();
+
+	RecordedSeconds += DeltaTime;
+	++Frame;
+}
+
+void USGSM_InputTraceSubsystem::StartRecording()
+{
+	if (!ensureAlwaysMsgf(!bReplaying, TEXT("Cannot record an input trace while replaying one")))
+	{
+		return;
+	}
+
+	if (bRecording)
+	{
+		return;
+	}
+
+	Trace = FSGSM_InputTrace();
+	RecordedBrains.Reset();
+	RecordedBrainIndices.Reset();
+	RecordedSeconds = 0.0;
+	Frame = 0;
+	bRecording = true;
+
+	UWorld* const World = GetWorld();
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		OnActorSpawned(*It);
+	}
+
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &USGSM_InputTraceSubsystem::OnActorSpawned));
+
+	UE_LOG(SMLogGeneric, Display, TEXT("Recording input trace of %d ships"), RecordedBrains.Num());
+}
+
+bool USGSM_InputTraceSubsystem::StopRecording(const FString& InFilename)
+{
+	if (!bRecording)
+	{
+		return false;
+	}
+
+	// Input issued since the last tick still belongs to the trace.
+	SampleDirtyBrains();
+	UnbindBrains();
+	bRecording = false;
+
+	Trace.NumFrames = Frame;
+	Trace.AverageDeltaTime = Frame > 0 ? static_cast<float>(RecordedSeconds / Frame) : Trace.AverageDeltaTime;
+
+	const FString Filename = InFilename.IsEmpty()
+		? GetDefaultTraceDirectory() / FString::Printf(TEXT("InputTrace_%s.sgtrace"), *FDateTime::Now().ToString())
+		: InFilename;
+
+	const bool bSaved = Trace.SaveToFile(Filename);
+	UE_CLOG(bSaved, SMLogGeneric, Display, TEXT("Saved input trace of %d ships, %d frames and %d changes to \"%s\""),
+		Trace.GetNumShips(), Trace.NumFrames, Trace.Records.Num(), *Filename);
+
+	Trace = FSGSM_InputTrace();
+	return bSaved;
+}
+
+void USGSM_InputTraceSubsystem::OnActorSpawned(AActor* InActor)
+{
+	if (!InActor)
+	{
+		return;
+	}
+
+	TInlineComponentArray<USGSM_PropulsionBrain*> Brains(InActor);
+	for (USGSM_PropulsionBrain* const Brain : Brains)
+	{
+		BindBrain(Brain);
+	}
+}
+
+void USGSM_InputTraceSubsystem::BindBrain(USGSM_PropulsionBrain* InBrain)
+{
+	if (RecordedBrainIndices.Contains(InBrain))
+	{
+		return;
+	}
+
+	FRecordedBrain& RecordedBrain = RecordedBrains.AddDefaulted_GetRef();
+	RecordedBrain.Brain = InBrain;
+	RecordedBrain.Ship = Trace.ShipNames.Add(GetNameSafe(InBrain->GetOwner()));
+
+	// Ships already under way start with their current input.
+	RecordedBrain.bDirty = true;
+
+	RecordedBrainIndices.Add(InBrain, RecordedBrains.Num() - 1);
+	InBrain->OnPilotInputIssued.AddUObject(this, &USGSM_InputTraceSubsystem::OnPilotInputIssued);
+}
+
+void USGSM_InputTraceSubsystem::UnbindBrains()
+{
+	if (UWorld* const World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+
+	for (const FRecordedBrain& RecordedBrain : RecordedBrains)
+	{
+		if (USGSM_PropulsionBrain* const Brain = RecordedBrain.Brain.Get())
+		{
+			Brain->OnPilotInputIssued.RemoveAll(this);
+		}
+	}
+
+	RecordedBrains.Reset();
+	RecordedBrainIndices.Reset();
+}
+
+void USGSM_InputTraceSubsystem::OnPilotInputIssued(USGSM_PropulsionBrain* InBrain)
+{
+	if (const int32* const Index = RecordedBrainIndices.Find(InBrain))
+	{
+		RecordedBrains[*Index].bDirty = true;
+	}
+}
+
+void USGSM_InputTraceSubsystem::SampleDirtyBrains()
+{
+	for (FRecordedBrain& RecordedBrain : RecordedBrains)
+	{
+		if (!RecordedBrain.bDirty)
+		{
+			continue;
+		}
+		RecordedBrain.bDirty = false;
+
+		const USGSM_PropulsionBrain* const Brain = RecordedBrain.Brain.Get();
+		if (!Brain)
+		{
+			continue;
+		}
+
+		const FSGSM_QuantizedPilotInput Input = FSGSM_QuantizedPilotInput::Quantize(Brain->GetPilotInput());
+		if (Input.HasSameInput(RecordedBrain.LastInput))
+		{
+			continue;
+		}
+
+		RecordedBrain.LastInput = Input;
+
+		FSGSM_InputTraceRecord& Record = Trace.Records.AddDefaulted_GetRef();
+		Record.Frame = Frame;
+		Record.Ship = RecordedBrain.Ship;
+		Record.Input = Input;
+	}
+}
+
+bool USGSM_InputTraceSubsystem::StartReplay(const FString& InFilename, bool bInLoop)
+{
+	FSGSM_InputTrace LoadedTrace;
+	if (!LoadedTrace.LoadFromFile(InFilename))
+	{
+		return false;
+	}
+
+	TMap<FString, USGSM_PropulsionBrain*> BrainsByName;
+	TArray<USGSM_PropulsionBrain*> UnmatchedBrains;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		TInlineComponentArray<USGSM_PropulsionBrain*> ActorBrains(*It);
+		for (USGSM_PropulsionBrain* const Brain : ActorBrains)
+		{
+			// Only the first brain of an actor can be told apart by name.
+			if (BrainsByName.Contains(It->GetName()))
+			{
+				UnmatchedBrains.Add(Brain);
+			}
+			else
+			{
+				BrainsByName.Add(It->GetName(), Brain);
+			}
+		}
+	}
+
+	// Recorded ships follow the ship of the same name, recording and replay usually run on the same map.
+	TArray<USGSM_PropulsionBrain*> Brains;
+	TArray<int32> UnmatchedShips;
+	Brains.SetNumZeroed(LoadedTrace.GetNumShips());
+	for (int32 Ship = 0; Ship < LoadedTrace.GetNumShips(); ++Ship)
+	{
+		if (!BrainsByName.RemoveAndCopyValue(LoadedTrace.ShipNames[Ship], Brains[Ship]))
+		{
+			UnmatchedShips.Add(Ship);
+		}
+	}
+
+	for (const TPair<FString, USGSM_PropulsionBrain*>& Pair : BrainsByName)
+	{
+		UnmatchedBrains.Add(Pair.Value);
+	}
+
+	// Renamed actors fall back to name order, which at least keeps the mapping stable between runs.
+	UnmatchedBrains.Sort([](const USGSM_PropulsionBrain& A, const USGSM_PropulsionBrain& B)
+	{
+		return GetNameSafe(A.GetOwner()) < GetNameSafe(B.GetOwner());
+	});
+
+	const int32 NumFallbacks = FMath::Min(UnmatchedShips.Num(), UnmatchedBrains.Num());
+	for (int32 Index = 0; Index < NumFallbacks; ++Index)
+	{
+		const int32 Ship = UnmatchedShips[Index];
+		Brains[Ship] = UnmatchedBrains[Index];
+		UE_LOG(SMLogGeneric, Display, TEXT("Recorded ship \"%s\" not found, replaying it onto \"%s\""), *LoadedTrace.ShipNames[Ship], *GetNameSafe(Brains[Ship]->GetOwner()));
+	}
+
+	for (int32 Index = NumFallbacks; Index < UnmatchedShips.Num(); ++Index)
+	{
+		UE_LOG(SMLogGeneric, Warning, TEXT("Recorded ship \"%s\" not found, its input is not replayed"), *LoadedTrace.ShipNames[UnmatchedShips[Index]]);
+	}
+
+	for (int32 Index = NumFallbacks; Index < UnmatchedBrains.Num(); ++Index)
+	{
+		UE_LOG(SMLogGeneric, Warning, TEXT("Ship \"%s\" is not in the input trace, it stays idle"), *GetNameSafe(UnmatchedBrains[Index]->GetOwner()));
+	}
+
+	StartReplayTrace(LoadedTrace, MoveTemp(Brains), bInLoop);
+	return true;
+}
+
+void USGSM_InputTraceSubsystem::StartReplayTrace(const FSGSM_InputTrace& InTrace, TArray<USGSM_PropulsionBrain*> InBrains, bool bInLoop)
+{
+	if (!ensureAlwaysMsgf(!bRecording, TEXT("Cannot replay an input trace while recording one")))
+	{
+		return;
+	}
+
+	StopReplay();
+
+	ReplayTrace = InTrace;
+	ReplayBrains.Reset(InBrains.Num());
+	int32 NumReplayedShips = 0;
+	for (USGSM_PropulsionBrain* const Brain : InBrains)
+	{
+		ReplayBrains.Add(Brain);
+		NumReplayedShips += Brain ? 1 : 0;
+	}
+
+	Player.Reset(&ReplayTrace, ReplayBrains.Num());
+	Frame = 0;
+	bLoopReplay = bInLoop;
+	bReplaying = true;
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &USGSM_InputTraceSubsystem::OnWorldTickStart);
+
+	UE_LOG(SMLogGeneric, Display, TEXT("Replaying input trace of %d ships and %d frames onto %d ships"), ReplayTrace.GetNumShips(), ReplayTrace.NumFrames, NumReplayedShips);
+}
+
+void USGSM_InputTraceSubsystem::StopReplay()
+{
+	if (!bReplaying)
+	{
+		return;
+	}
+
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	WorldTickStartHandle.Reset();
+
+	// Leave the ships idle rather than holding the last replayed input.
+	for (const TWeakObjectPtr<USGSM_PropulsionBrain>& Brain : ReplayBrains)
+	{
+		if (Brain.IsValid())
+		{
+			Brain->ApplyPilotInput(FSGSM_PilotInput());
+		}
+	}
+
+	ReplayBrains.Reset();
+	Player.Reset(nullptr, 0);
+	ReplayTrace = FSGSM_InputTrace();
+	bReplaying = false;
+}
+
+void USGSM_InputTraceSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick InTickType, float InDeltaTime)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	Player.Advance(Frame, bLoopReplay);
+
+	if (Player.IsFinished())
+	{
+		UE_LOG(SMLogGeneric, Display, TEXT("Input trace replay finished after %d frames"), Frame);
+		StopReplay();
+		return;
+	}
+
+	for (int32 ShipIndex = 0; ShipIndex < ReplayBrains.Num(); ++ShipIndex)
+	{
+		if (USGSM_PropulsionBrain* const Brain = ReplayBrains[ShipIndex].Get())
+		{
+			Brain->ApplyPilotInput(Player.GetInput(ShipIndex));
+		}
+	}
+
+	++Frame;
+}
+
+static USGSM_InputTraceSubsystem* GetInputTraceSubsystem(UWorld* InWorld)
+{
+	USGSM_InputTraceSubsystem* const InputTraceSubsystem = InWorld ? InWorld->GetSubsystem<USGSM_InputTraceSubsystem>() : nullptr;
+	UE_CLOG(!InputTraceSubsystem, SMLogGeneric, Warning, TEXT("Input traces are only available in game worlds"));
+	return InputTraceSubsystem;
+}
+
+static FAutoConsoleCommandWithWorld GSGSM_TraceRecordCommand(
+	TEXT("sgsm.Trace.Record"),
+	TEXT("Starts recording the pilot input of every ship in the world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		if (USGSM_InputTraceSubsystem* const InputTraceSubsystem = GetInputTraceSubsystem(World))
+		{
+			InputTraceSubsystem->StartRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSGSM_TraceStopCommand(
+	TEXT("sgsm.Trace.Stop"),
+	TEXT("Stops recording and saves the input trace, or stops a replay. Args: [File]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USGSM_InputTraceSubsystem* const InputTraceSubsystem = GetInputTraceSubsystem(World))
+		{
+			if (InputTraceSubsystem->IsRecording())
+			{
+				InputTraceSubsystem->StopRecording(Args.IsValidIndex(0) ? Args[0] : FString());
+			}
+			InputTraceSubsystem->StopReplay();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSGSM_TraceReplayCommand(
+	TEXT("sgsm.Trace.Replay"),
+	TEXT("Replays an input trace onto every ship in the world. Args: <File> [Loop]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!Args.IsValidIndex(0))
+		{
+			UE_LOG(SMLogGeneric, Warning, TEXT("Usage: sgsm.Trace.Replay <File> [Loop]"));
+			return;
+		}
+
+		if (USGSM_InputTraceSubsystem* const InputTraceSubsystem = GetInputTraceSubsystem(World))
+		{
+			FString Filename = Args[0];
+			if (FPaths::IsRelative(Filename) && !FPaths::FileExists(Filename))
+			{
+				Filename = USGSM_InputTraceSubsystem::GetDefaultTraceDirectory() / Filename;
+			}
+			InputTraceSubsystem->StartReplay(Filename, Args.IsValidIndex(1) && Args[1].ToBool());
+		}
+	}));
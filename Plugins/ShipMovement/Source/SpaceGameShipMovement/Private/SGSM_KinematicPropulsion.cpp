@@ -0,0 +1,169 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_KinematicPropulsion.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_RocketLayout.h"
+#include "HAL/IConsoleManager.h"
+
+
+static int32 GSGSM_RocketMountTorque = 0;
+static FAutoConsoleVariableRef CVarSGSM_RocketMountTorque(
+	TEXT("sgsm.Propulsion.RocketMountTorque"),
+	GSGSM_RocketMountTorque,
+	TEXT("When enabled rockets also apply the torque of their mount offset around the center of mass, otherwise they push through the center of mass (default)."),
+	ECVF_Default);
+
+namespace SGSM_KinematicPropulsion
+{
+	bool IsRocketMountTorqueEnabled()
+	{
+		return GSGSM_RocketMountTorque != 0;
+	}
+
+	FVector GetThrustOutput(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FQuat& InBodyRotation, const FVector& InDirection)
+	{
+		const double BoostScale = InInput.bBoosting ? InInput.BoostPercent : 0;
+
+		const FVector ThrustOutput = SGSM_Utils::GetThrustEngagementVector(InBodyRotation, InDirection, InSpecs.ThrustMultiplier, InSpecs.BoostMultiplier, BoostScale);
+
+		return ThrustOutput * InSpecs.MaxLinearCentinewtons;
+	}
+
+	double GetMaxThrustMagnitude(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FQuat& InBodyRotation, const FVector& InDirection)
+	{
+		const double BoostScale = InInput.bBoosting ? InInput.BoostPercent : 0;
+
+		return SGSM_PropulsionMath::GetMaxThrustMagnitude(InSpecs.Envelope.GetMath(), SGSM_PropulsionMath::ToMath(InBodyRotation), SGSM_PropulsionMath::ToMath(InDirection), BoostScale);
+	}
+
+	void TickThrusters(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FSGSM_KinematicBody& InBody, double InHorizon, FThrusterResult& OutResult)
+	{
+		if (!InInput.LinearThrustDirection.IsNearlyZero())
+		{
+			const FVector AppliedThrust = GetThrustOutput(InSpecs, InInput, InBody.Rotation, InInput.LinearThrustDirection);
+
+			OutResult.Force += AppliedThrust;
+			OutResult.LinearThrustVector = AppliedThrust;
+			OutResult.bLinearThrustActive = true;
+		}
+		else if (InInput.bLinearBrake && !InBody.LinearVelocity.IsNearlyZero())
+		{
+			// Just enough force to come to rest over the horizon, capped by the envelope.
+			const FVector Direction = InBody.LinearVelocity.GetSafeNormal2D();
+			const double MaxForceMagnitude = GetMaxThrustMagnitude(InSpecs, InInput, InBody.Rotation, -Direction);
+			const double StoppingForce = InBody.Mass * InBody.LinearVelocity.Size2D() / InHorizon;
+
+			const FVector AppliedThrust = FMath::Min(StoppingForce, MaxForceMagnitude) * -Direction;
+
+			OutResult.Force += AppliedThrust;
+			OutResult.LinearThrustVector = AppliedThrust;
+		}
+
+		const double MaxTorque = InSpecs.MaxAngularCentinewtons;
+		const double MaxRotationRadPerSec = FMath::DegreesToRadians(InSpecs.MaxRotationDegPerSec);
+
+		TOptional<double> TargetYawRate;
+
+		if (!InInput.AngularThrustDirection.IsNearlyZero())
+		{
+			if (InInput.bAlternativeTurning)
+			{
+				// Turn rate that can still stop on the requested heading at full torque.
+				const FVector ForwardVector = InBody.Rotation.GetForwardVector();
+				const FVector DirectionVector = FVector(-InInput.AngularThrustDirection.Y, InInput.AngularThrustDirection.X, 0);
+				const double Angle = FMath::Atan2(FVector::CrossProduct(ForwardVector, DirectionVector).Z, FVector::DotProduct(ForwardVector, DirectionVector));
+				const double MaxAngularAcceleration = MaxTorque / InBody.Inertia;
+
+				TargetYawRate = FMath::Sign(Angle) * FMath::Min(MaxRotationRadPerSec, FMath::Sqrt(2.0 * MaxAngularAcceleration * FMath::Abs(Angle)));
+			}
+			else
+			{
+				TargetYawRate = FMath::Clamp(InInput.AngularThrustDirection.X, -1.0, 1.0) * MaxRotationRadPerSec;
+			}
+
+			OutResult.bAngularThrustActive = true;
+		}
+		else if (InInput.bAngularBrake)
+		{
+			TargetYawRate = 0.0;
+		}
+
+		if (TargetYawRate.IsSet())
+		{
+			const double Torque = FMath::Clamp(InBody.Inertia * (TargetYawRate.GetValue() - InBody.AngularVelocity.Z) / InHorizon, -MaxTorque, MaxTorque);
+
+			OutResult.Torque += FVector::UpVector * Torque;
+			OutResult.CurrentYawTorque = Torque;
+		}
+	}
+
+	double AccumulateRocketBoost(const FSGSM_RocketLayout& InLayout, const FSGSM_KinematicBody& InBody, const FVector& InDirection, double InScale, FVector& InOutForce, FVector& InOutTorque)
+	{
+		const int32 NumRockets = InLayout.Num();
+		if (NumRockets == 0 || InScale <= 0.0)
+		{
+			return 0.0;
+		}
+
+		const bool bMountTorque = IsRocketMountTorqueEnabled();
+		const SGSM_PropulsionMath::FVec3 LocalDirection = SGSM_PropulsionMath::ToMath(InBody.Rotation.UnrotateVector(InDirection));
+
+		double TotalPower = 0.0;
+
+		for (int32 Index = 0; Index < NumRockets; ++Index)
+		{
+			const double Engagement = SGSM_PropulsionMath::GetRocketEngagement(LocalDirection, SGSM_PropulsionMath::ToMath(InLayout.LocalForward[Index]), SGSM_PropulsionMath::ToMath(InLayout.LocalRight[Index]));
+			const double Power = FMath::Clamp(InScale * Engagement, 0.0, 1.0);
+			if (Power <= 0.0)
+			{
+				continue;
+			}
+
+			const FVector Thrust = InBody.Rotation.RotateVector(InLayout.LocalForward[Index]) * (InLayout.MaxThrust[Index] * Power);
+			InOutForce += Thrust;
+
+			if (bMountTorque)
+			{
+				const FVector LeverArm = InBody.Rotation.RotateVector(InLayout.MountOffset[Index] - InBody.CenterOfMass);
+				InOutTorque += FVector::CrossProduct(LeverArm, Thrust);
+			}
+
+			TotalPower += Power;
+		}
+
+		return TotalPower / NumRockets;
+	}
+
+	void Integrate(FSGSM_KinematicBody& InOutBody, const FVector& InForce, const FVector& InTorque, double DeltaTime)
+	{
+		InOutBody.LinearVelocity += InForce / InOutBody.Mass * DeltaTime;
+		InOutBody.AngularVelocity += InTorque / InOutBody.Inertia * DeltaTime;
+		InOutBody.Location += InOutBody.LinearVelocity * DeltaTime;
+
+		const double AngularSpeed = InOutBody.AngularVelocity.Size();
+		if (AngularSpeed > UE_DOUBLE_SMALL_NUMBER)
+		{
+			InOutBody.Rotation = (FQuat(InOutBody.AngularVelocity / AngularSpeed, AngularSpeed * DeltaTime) * InOutBody.Rotation).GetNormalized();
+		}
+	}
+
+	FSGSM_ThrusterInputSnapshot MakeThrusterInput(const FSGSM_PilotInput& InPilotInput, const FQuat& InBodyRotation)
+	{
+		FSGSM_ThrusterInputSnapshot Input;
+		Input.LinearThrustDirection = FVector(InPilotInput.LinearThrust, 0.0);
+		Input.AngularThrustDirection = FVector(InPilotInput.AngularThrust, 0.0);
+		Input.bLinearBrake = InPilotInput.bLinearBrake;
+		Input.bAngularBrake = InPilotInput.bAngularBrake;
+		Input.bAlternativeTurning = InPilotInput.bAlternativeTurning;
+		Input.bBoosting = InPilotInput.bBoosting;
+		Input.BoostPercent = InPilotInput.bBoosting ? InPilotInput.BoostValue : 0.0;
+
+		// Boosting without a thrust direction pushes along the nose, as the brain does.
+		if (Input.bBoosting && Input.LinearThrustDirection.IsNearlyZero())
+		{
+			Input.LinearThrustDirection = InBodyRotation.GetForwardVector();
+		}
+
+		return Input;
+	}
+}
@@ -6,6 +6,8 @@
 DEFINE_LOG_CATEGORY(SMLogBrain);
 DEFINE_LOG_CATEGORY(SMLogThruster);
 DEFINE_LOG_CATEGORY(SMLogRocket);
+DEFINE_LOG_CATEGORY(SMLogPropulsion);
+DEFINE_LOG_CATEGORY(SMLogNet);
 
 DEFINE_LOG_CATEGORY(SMLogUtils);
 
@@ -0,0 +1,93 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_MassPropulsionProcessor.h"
+#include "SGSM_MassFragments.h"
+#include "SGSM_KinematicPropulsion.h"
+#include "SGSM_Stats.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+
+
+USGSM_MassPropulsionProcessor::USGSM_MassPropulsionProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+}
+
+void USGSM_MassPropulsionProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSGSM_MassShipBodyFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSGSM_MassPilotInputFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FSGSM_MassPropulsionOutputFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FSGSM_MassShipClassFragment>();
+	EntityQuery.AddConstSharedRequirement<FSGSM_MassThrusterSpecsFragment>();
+	EntityQuery.AddConstSharedRequirement<FSGSM_MassRocketLayoutFragment>();
+	EntityQuery.AddTagRequirement<FSGSM_MassShipTag>(EMassFragmentPresence::All);
+}
+
+void USGSM_MassPropulsionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_MassPropulsion);
+
+	// Every chunk holds ships of one class, so the shared fragments are fetched once per chunk.
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& ChunkContext)
+	{
+		const float DeltaTime = ChunkContext.GetDeltaTimeSeconds();
+		if (DeltaTime <= 0.f)
+		{
+			return;
+		}
+
+		const TArrayView<FTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FSGSM_MassShipBodyFragment> Bodies = ChunkContext.GetMutableFragmentView<FSGSM_MassShipBodyFragment>();
+		const TConstArrayView<FSGSM_MassPilotInputFragment> Inputs = ChunkContext.GetFragmentView<FSGSM_MassPilotInputFragment>();
+		const TArrayView<FSGSM_MassPropulsionOutputFragment> Outputs = ChunkContext.GetMutableFragmentView<FSGSM_MassPropulsionOutputFragment>();
+
+		const FSGSM_MassShipClassFragment& ShipClass = ChunkContext.GetConstSharedFragment<FSGSM_MassShipClassFragment>();
+		const FSGSM_ThrusterSpecs& Specs = ChunkContext.GetConstSharedFragment<FSGSM_MassThrusterSpecsFragment>().Specs;
+		const FSGSM_RocketLayout& RocketLayout = ChunkContext.GetConstSharedFragment<FSGSM_MassRocketLayoutFragment>().Layout;
+
+		for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); ++EntityIndex)
+		{
+			FTransform& Transform = Transforms[EntityIndex].GetMutableTransform();
+			FSGSM_MassShipBodyFragment& BodyFragment = Bodies[EntityIndex];
+			const FSGSM_PilotInput& PilotInput = Inputs[EntityIndex].Input;
+
+			FSGSM_KinematicBody Body;
+			Body.Location = Transform.GetLocation();
+			Body.Rotation = Transform.GetRotation();
+			Body.LinearVelocity = BodyFragment.LinearVelocity;
+			Body.AngularVelocity = BodyFragment.AngularVelocity;
+			Body.CenterOfMass = ShipClass.CenterOfMass;
+			Body.Mass = ShipClass.Mass;
+			Body.Inertia = ShipClass.Inertia;
+
+			const FSGSM_ThrusterInputSnapshot ThrusterInput = SGSM_KinematicPropulsion::MakeThrusterInput(PilotInput, Body.Rotation);
+
+			SGSM_KinematicPropulsion::FThrusterResult Result;
+			SGSM_KinematicPropulsion::TickThrusters(Specs, ThrusterInput, Body, DeltaTime, Result);
+
+			double AverageRocketPower = 0.0;
+			if (PilotInput.bBoosting)
+			{
+				const double DirectionScale = PilotInput.LinearThrust.IsNearlyZero() ? 1.0 : FMath::Min(PilotInput.LinearThrust.Size(), 1.0);
+				AverageRocketPower = SGSM_KinematicPropulsion::AccumulateRocketBoost(RocketLayout, Body, ThrusterInput.LinearThrustDirection, PilotInput.BoostValue * DirectionScale, Result.Force, Result.Torque);
+			}
+
+			SGSM_KinematicPropulsion::Integrate(Body, Result.Force, Result.Torque, DeltaTime);
+
+			Transform.SetLocation(Body.Location);
+			Transform.SetRotation(Body.Rotation);
+			BodyFragment.LinearVelocity = Body.LinearVelocity;
+			BodyFragment.AngularVelocity = Body.AngularVelocity;
+
+			FSGSM_MassPropulsionOutputFragment& Output = Outputs[EntityIndex];
+			Output.LinearThrustVector = Result.LinearThrustVector;
+			Output.CurrentYawTorque = Result.CurrentYawTorque;
+			Output.AverageRocketPower = static_cast<float>(AverageRocketPower);
+		}
+	});
+}
@@ -0,0 +1,508 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_MassShipSubsystem.h"
+#include "SGSM_MassFragments.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_PropulsionSubsystem.h"
+#include "SGSM_ThrustersComponent.h"
+#include "SGSM_Utils.h"
+#include "SGSM_LogCategory.h"
+#include "SGSM_Stats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+
+
+static float GSGSM_MassPawnDistance = 50000.f;
+static FAutoConsoleVariableRef CVarSGSM_MassPawnDistance(
+	TEXT("sgsm.Mass.PawnDistance"),
+	GSGSM_MassPawnDistance,
+	TEXT("Distance to the nearest player below which Mass ships are converted to full pawns."),
+	ECVF_Default);
+
+static float GSGSM_MassHysteresis = 0.1f;
+static FAutoConsoleVariableRef CVarSGSM_MassHysteresis(
+	TEXT("sgsm.Mass.Hysteresis"),
+	GSGSM_MassHysteresis,
+	TEXT("Fraction of sgsm.Mass.PawnDistance a converted pawn has to move beyond it before it returns to Mass, to avoid flickering at the boundary."),
+	ECVF_Default);
+
+static int32 GSGSM_MassMaxConversionsPerFrame = 8;
+static FAutoConsoleVariableRef CVarSGSM_MassMaxConversionsPerFrame(
+	TEXT("sgsm.Mass.MaxConversionsPerFrame"),
+	GSGSM_MassMaxConversionsPerFrame,
+	TEXT("Maximum number of ships converted between entity and pawn per frame, in each direction."),
+	ECVF_Default);
+
+USGSM_MassShipSubsystem* USGSM_MassShipSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? World->GetSubsystem<USGSM_MassShipSubsystem>() : nullptr;
+}
+
+void USGSM_MassShipSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency<UMassEntitySubsystem>();
+
+	Super::Initialize(Collection);
+
+	ConversionQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	ConversionQuery.AddTagRequirement<FSGSM_MassShipTag>(EMassFragmentPresence::All);
+}
+
+void USGSM_MassShipSubsystem::Deinitialize()
+{
+	ConvertedPawns.Reset();
+	ShipClasses.Reset();
+
+	Super::Deinitialize();
+}
+
+bool USGSM_MassShipSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId USGSM_MassShipSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGSM_MassShipSubsystem, STATGROUP_Tickables);
+}
+
+FMassEntityManager* USGSM_MassShipSubsystem::GetEntityManager() const
+{
+	UMassEntitySubsystem* const EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	return EntitySubsystem ? &EntitySubsystem->GetMutableEntityManager() : nullptr;
+}
+
+int32 USGSM_MassShipSubsystem::GetNumEntityShips() const
+{
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	return EntityManager ? ConversionQuery.GetNumMatchingEntities(*EntityManager) : 0;
+}
+
+void USGSM_MassShipSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_MassConversion);
+
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	if (!EntityManager)
+	{
+		return;
+	}
+
+	// Pawn brains expect their held input every frame, as they would get it from a player or the trace replay.
+	for (auto It = ConvertedPawns.CreateIterator(); It; ++It)
+	{
+		APawn* const Pawn = It.Value().Get();
+		if (!Pawn || !EntityManager->IsEntityValid(It.Key()))
+		{
+			// Destroyed as a pawn, the ship is gone.
+			if (EntityManager->IsEntityValid(It.Key()))
+			{
+				EntityManager->DestroyEntity(It.Key());
+			}
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (USGSM_PropulsionBrain* const Brain = Pawn->FindComponentByClass<USGSM_PropulsionBrain>())
+		{
+			Brain->ApplyPilotInput(EntityManager->GetFragmentDataChecked<FSGSM_MassPilotInputFragment>(It.Key()).Input);
+		}
+	}
+
+	UpdateConversions();
+
+	SET_DWORD_STAT(STAT_SGSM_MassShips, GetNumEntityShips());
+}
+
+void USGSM_MassShipSubsystem::UpdateConversions()
+{
+	FMassEntityManager& EntityManager = *GetEntityManager();
+
+	TArray<FVector, TInlineAllocator<4>> Viewpoints;
+	USGSM_PropulsionSubsystem::GetPlayerViewpoints(GetWorld(), Viewpoints);
+
+	// Without players there is nobody to convert for, everything stays as it is.
+	if (Viewpoints.IsEmpty())
+	{
+		return;
+	}
+
+	auto GetDistanceSquared = [&Viewpoints](const FVector& InLocation)
+	{
+		double MinDistanceSquared = TNumericLimits<double>::Max();
+		for (const FVector& Viewpoint : Viewpoints)
+		{
+			MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(Viewpoint, InLocation));
+		}
+		return MinDistanceSquared;
+	};
+
+	const double PawnDistanceSquared = FMath::Square(static_cast<double>(GSGSM_MassPawnDistance));
+	const double EntityDistanceSquared = FMath::Square(GSGSM_MassPawnDistance * (1.0 + GSGSM_MassHysteresis));
+	const int32 MaxConversions = FMath::Max(GSGSM_MassMaxConversionsPerFrame, 1);
+
+	TArray<FMassEntityHandle, TInlineAllocator<16>> ToEntities;
+	for (const TPair<FMassEntityHandle, TWeakObjectPtr<APawn>>& Pair : ConvertedPawns)
+	{
+		const APawn* const Pawn = Pair.Value.Get();
+		if (Pawn && !Pawn->IsPlayerControlled() && GetDistanceSquared(Pawn->GetActorLocation()) > EntityDistanceSquared)
+		{
+			ToEntities.Add(Pair.Key);
+			if (ToEntities.Num() == MaxConversions)
+			{
+				break;
+			}
+		}
+	}
+
+	for (const FMassEntityHandle Entity : ToEntities)
+	{
+		ReturnToEntity(Entity, ConvertedPawns.FindAndRemoveChecked(Entity).Get());
+	}
+
+	TArray<FMassEntityHandle, TInlineAllocator<16>> ToPawns;
+	FMassExecutionContext Context(EntityManager);
+	ConversionQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& ChunkContext)
+	{
+		const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities() && ToPawns.Num() < MaxConversions; ++EntityIndex)
+		{
+			if (GetDistanceSquared(Transforms[EntityIndex].GetTransform().GetLocation()) < PawnDistanceSquared)
+			{
+				ToPawns.Add(ChunkContext.GetEntity(EntityIndex));
+			}
+		}
+	});
+
+	for (const FMassEntityHandle Entity : ToPawns)
+	{
+		ConvertToPawn(Entity);
+	}
+}
+
+const USGSM_MassShipSubsystem::FShipClassData* USGSM_MassShipSubsystem::FindOrCaptureShipClass(TSubclassOf<APawn> InShipClass)
+{
+	if (const FShipClassData* const ShipClassData = ShipClasses.Find(InShipClass))
+	{
+		return ShipClassData;
+	}
+
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	if (!ensureAlwaysMsgf(EntityManager && InShipClass, TEXT("Mass ships need a ship class and a Mass entity manager")))
+	{
+		return nullptr;
+	}
+
+	// Components of Blueprint ships only exist on instances, so the class is captured from a short-lived template pawn.
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	APawn* const TemplatePawn = GetWorld()->SpawnActor<APawn>(InShipClass, FTransform::Identity, SpawnParameters);
+	USGSM_PropulsionBrain* const Brain = TemplatePawn ? TemplatePawn->FindComponentByClass<USGSM_PropulsionBrain>() : nullptr;
+	const UPrimitiveComponent* const Body = TemplatePawn ? Cast<UPrimitiveComponent>(TemplatePawn->GetRootComponent()) : nullptr;
+
+	if (!Brain || !Brain->ThrustersComponent || !Body)
+	{
+		UE_LOG(SMLogGeneric, Error, TEXT("%s cannot run as a Mass ship, it needs a propulsion brain with thrusters and a primitive root"), *GetNameSafe(InShipClass));
+		if (TemplatePawn)
+		{
+			TemplatePawn->Destroy();
+		}
+		return nullptr;
+	}
+
+	// The template cannot wait for an async load, its specs are captured right away.
+	if (Brain->IsShipClassLoading())
+	{
+		Brain->SetShipClass(Brain->GetShipClass().LoadSynchronous());
+	}
+
+	FSGSM_MassShipClassFragment ShipClassFragment;
+	ShipClassFragment.ShipClass = InShipClass;
+
+	if (const FBodyInstance* const BodyInstance = Body->GetBodyInstance(); BodyInstance && BodyInstance->IsValidBodyInstance())
+	{
+		ShipClassFragment.Mass = FMath::Max(static_cast<double>(BodyInstance->GetBodyMass()), UE_KINDA_SMALL_NUMBER);
+		ShipClassFragment.Inertia = FMath::Max(static_cast<double>(BodyInstance->GetBodyInertiaTensor().GetMax()), UE_KINDA_SMALL_NUMBER);
+		ShipClassFragment.CenterOfMass = Body->GetComponentTransform().InverseTransformPositionNoScale(BodyInstance->GetCOMPosition());
+	}
+
+	FSGSM_MassThrusterSpecsFragment SpecsFragment;
+	SpecsFragment.Specs = Brain->ThrustersComponent->BuildSpecs();
+
+	FSGSM_MassRocketLayoutFragment RocketLayoutFragment;
+	RocketLayoutFragment.Layout = Brain->GetRocketLayout();
+
+	TemplatePawn->Destroy();
+
+	// Specs and layout are not reflected, so the fragments are told apart by the class they were captured from.
+	const uint32 ClassHash = GetTypeHash(InShipClass.Get());
+
+	FShipClassData& ShipClassData = ShipClasses.Add(InShipClass);
+	ShipClassData.SharedValues.AddConstSharedFragment(EntityManager->GetOrCreateConstSharedFragmentByHash(ClassHash, ShipClassFragment));
+	ShipClassData.SharedValues.AddConstSharedFragment(EntityManager->GetOrCreateConstSharedFragmentByHash(ClassHash, SpecsFragment));
+	ShipClassData.SharedValues.AddConstSharedFragment(EntityManager->GetOrCreateConstSharedFragmentByHash(ClassHash, RocketLayoutFragment));
+	ShipClassData.SharedValues.Sort();
+
+	if (!ShipArchetype.IsValid())
+	{
+		ShipArchetype = EntityManager->CreateArchetype(
+		{
+			FTransformFragment::StaticStruct(),
+			FSGSM_MassShipBodyFragment::StaticStruct(),
+			FSGSM_MassPilotInputFragment::StaticStruct(),
+			FSGSM_MassPropulsionOutputFragment::StaticStruct(),
+			FSGSM_MassShipTag::StaticStruct()
+		});
+	}
+
+	UE_LOG(SMLogGeneric, Log, TEXT("Captured Mass ship class %s with %d rockets"), *GetNameSafe(InShipClass), RocketLayoutFragment.Layout.Num());
+	return &ShipClassData;
+}
+
+bool USGSM_MassShipSubsystem::SpawnShips(TSubclassOf<APawn> InShipClass, TConstArrayView<FTransform> InTransforms, TArray<FMassEntityHandle>& OutEntities)
+{
+	const FShipClassData* const ShipClassData = FindOrCaptureShipClass(InShipClass);
+	if (!ShipClassData)
+	{
+		return false;
+	}
+
+	FMassEntityManager& EntityManager = *GetEntityManager();
+
+	const int32 FirstEntity = OutEntities.Num();
+	TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext = EntityManager.BatchCreateEntities(ShipArchetype, ShipClassData->SharedValues, InTransforms.Num(), OutEntities);
+
+	for (int32 Index = 0; Index < InTransforms.Num(); ++Index)
+	{
+		EntityManager.GetFragmentDataChecked<FTransformFragment>(OutEntities[FirstEntity + Index]).SetTransform(InTransforms[Index]);
+	}
+
+	return true;
+}
+
+FMassEntityHandle USGSM_MassShipSubsystem::SpawnShip(TSubclassOf<APawn> InShipClass, const FTransform& InTransform, const FVector& InLinearVelocity)
+{
+	TArray<FMassEntityHandle> Entities;
+	if (!SpawnShips(InShipClass, MakeArrayView(&InTransform, 1), Entities))
+	{
+		return FMassEntityHandle();
+	}
+
+	GetEntityManager()->GetFragmentDataChecked<FSGSM_MassShipBodyFragment>(Entities[0]).LinearVelocity = InLinearVelocity;
+	return Entities[0];
+}
+
+void USGSM_MassShipSubsystem::DestroyShip(FMassEntityHandle InEntity)
+{
+	if (TWeakObjectPtr<APawn> Pawn; ConvertedPawns.RemoveAndCopyValue(InEntity, Pawn) && Pawn.IsValid())
+	{
+		Pawn->Destroy();
+	}
+
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	if (EntityManager && EntityManager->IsEntityValid(InEntity))
+	{
+		EntityManager->DestroyEntity(InEntity);
+	}
+}
+
+void USGSM_MassShipSubsystem::SetShipInput(FMassEntityHandle InEntity, const FSGSM_PilotInput& InPilotInput)
+{
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(InEntity))
+	{
+		return;
+	}
+
+	EntityManager->GetFragmentDataChecked<FSGSM_MassPilotInputFragment>(InEntity).Input = InPilotInput;
+}
+
+APawn* USGSM_MassShipSubsystem::GetShipPawn(FMassEntityHandle InEntity) const
+{
+	const TWeakObjectPtr<APawn>* const Pawn = ConvertedPawns.Find(InEntity);
+	return Pawn ? Pawn->Get() : nullptr;
+}
+
+FTransform USGSM_MassShipSubsystem::GetPawnBodyState(const APawn* InPawn, FVector& OutLinearVelocity, FVector& OutAngularVelocity)
+{
+	OutLinearVelocity = FVector::ZeroVector;
+	OutAngularVelocity = FVector::ZeroVector;
+
+	if (const UPrimitiveComponent* const Body = Cast<UPrimitiveComponent>(InPawn->GetRootComponent()))
+	{
+		OutLinearVelocity = Body->GetPhysicsLinearVelocity();
+		OutAngularVelocity = Body->GetPhysicsAngularVelocityInRadians();
+	}
+
+	return InPawn->GetActorTransform();
+}
+
+APawn* USGSM_MassShipSubsystem::ConvertToPawn(FMassEntityHandle InEntity)
+{
+	FMassEntityManager* const EntityManager = GetEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(InEntity))
+	{
+		return nullptr;
+	}
+
+	if (APawn* const ExistingPawn = GetShipPawn(InEntity))
+	{
+		return ExistingPawn;
+	}
+
+	const FSGSM_MassShipClassFragment& ShipClass = EntityManager->GetConstSharedFragmentDataChecked<FSGSM_MassShipClassFragment>(InEntity);
+	const FTransform& Transform = EntityManager->GetFragmentDataChecked<FTransformFragment>(InEntity).GetTransform();
+	const FSGSM_MassShipBodyFragment& BodyFragment = EntityManager->GetFragmentDataChecked<FSGSM_MassShipBodyFragment>(InEntity);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	APawn* const Pawn = GetWorld()->SpawnActor<APawn>(ShipClass.ShipClass, Transform, SpawnParameters);
+	if (!Pawn)
+	{
+		UE_LOG(SMLogGeneric, Warning, TEXT("Failed to convert Mass ship to %s"), *GetNameSafe(ShipClass.ShipClass));
+		return nullptr;
+	}
+
+	if (UPrimitiveComponent* const Body = Cast<UPrimitiveComponent>(Pawn->GetRootComponent()))
+	{
+		Body->SetPhysicsLinearVelocity(BodyFragment.LinearVelocity);
+		Body->SetPhysicsAngularVelocityInRadians(BodyFragment.AngularVelocity);
+	}
+
+	if (USGSM_PropulsionBrain* const Brain = Pawn->FindComponentByClass<USGSM_PropulsionBrain>())
+	{
+		Brain->ApplyPilotInput(EntityManager->GetFragmentDataChecked<FSGSM_MassPilotInputFragment>(InEntity).Input);
+	}
+
+	// The entity stays around with its input, but is no longer stepped.
+	EntityManager->RemoveTagFromEntity(InEntity, FSGSM_MassShipTag::StaticStruct());
+	EntityManager->AddTagToEntity(InEntity, FSGSM_MassShipPawnTag::StaticStruct());
+
+	ConvertedPawns.Add(InEntity, Pawn);
+	return Pawn;
+}
+
+void USGSM_MassShipSubsystem::ReturnToEntity(FMassEntityHandle InEntity, APawn* InPawn)
+{
+	FMassEntityManager& EntityManager = *GetEntityManager();
+
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+	const FTransform Transform = GetPawnBodyState(InPawn, LinearVelocity, AngularVelocity);
+
+	EntityManager.GetFragmentDataChecked<FTransformFragment>(InEntity).SetTransform(Transform);
+
+	FSGSM_MassShipBodyFragment& BodyFragment = EntityManager.GetFragmentDataChecked<FSGSM_MassShipBodyFragment>(InEntity);
+	BodyFragment.LinearVelocity = LinearVelocity;
+	BodyFragment.AngularVelocity = AngularVelocity;
+
+	EntityManager.RemoveTagFromEntity(InEntity, FSGSM_MassShipPawnTag::StaticStruct());
+	EntityManager.AddTagToEntity(InEntity, FSGSM_MassShipTag::StaticStruct());
+
+	InPawn->Destroy();
+}
+
+FMassEntityHandle USGSM_MassShipSubsystem::ConvertToEntity(APawn* InPawn)
+{
+	if (!InPawn || InPawn->IsPlayerControlled())
+	{
+		return FMassEntityHandle();
+	}
+
+	for (const TPair<FMassEntityHandle, TWeakObjectPtr<APawn>>& Pair : ConvertedPawns)
+	{
+		if (Pair.Value == InPawn)
+		{
+			const FMassEntityHandle Entity = Pair.Key;
+			ConvertedPawns.Remove(Entity);
+			ReturnToEntity(Entity, InPawn);
+			return Entity;
+		}
+	}
+
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+	const FTransform Transform = GetPawnBodyState(InPawn, LinearVelocity, AngularVelocity);
+
+	const FMassEntityHandle Entity = SpawnShip(InPawn->GetClass(), Transform, LinearVelocity);
+	if (!Entity.IsSet())
+	{
+		return Entity;
+	}
+
+	FMassEntityManager& EntityManager = *GetEntityManager();
+	EntityManager.GetFragmentDataChecked<FSGSM_MassShipBodyFragment>(Entity).AngularVelocity = AngularVelocity;
+
+	if (const USGSM_PropulsionBrain* const Brain = InPawn->FindComponentByClass<USGSM_PropulsionBrain>())
+	{
+		EntityManager.GetFragmentDataChecked<FSGSM_MassPilotInputFragment>(Entity).Input = Brain->GetPilotInput();
+	}
+
+	InPawn->Destroy();
+	return Entity;
+}
+
+/*
+ * Spawns Mass traffic on a ring around the origin, cruising with a slow turn, to check fleet scale on a server.
+ * Usage: sgsm.Mass.SpawnTraffic [Count=1000] [ShipClass=/SpaceGameShipMovement/Demo/BP_DemoShipPawn.BP_DemoShipPawn_C]
+ */
+static FAutoConsoleCommandWithWorldAndArgs GSGSM_MassSpawnTrafficCommand(
+	TEXT("sgsm.Mass.SpawnTraffic"),
+	TEXT("Spawns cruising Mass ships around the origin. Args: [Count] [ShipClass]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		USGSM_MassShipSubsystem* const MassShipSubsystem = USGSM_MassShipSubsystem::Get(World);
+		if (!MassShipSubsystem)
+		{
+			UE_LOG(SMLogGeneric, Warning, TEXT("Mass ships are only available in game worlds"));
+			return;
+		}
+
+		const int32 Count = Args.IsValidIndex(0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+		const FString ShipClassPath = Args.IsValidIndex(1) ? Args[1] : FString(SGSM_Utils::DemoShipClassPath);
+
+		UClass* const ShipClass = LoadClass<APawn>(nullptr, *ShipClassPath);
+		if (!ShipClass)
+		{
+			UE_LOG(SMLogGeneric, Warning, TEXT("Failed to load ship class \"%s\""), *ShipClassPath);
+			return;
+		}
+
+		FRandomStream Random(Count);
+		TArray<FTransform> Transforms;
+		Transforms.Reserve(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const double Angle = Random.FRandRange(0.0, UE_TWO_PI);
+			const FVector Location = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0) * Random.FRandRange(100000.0, 2000000.0);
+			Transforms.Emplace(FRotator(0.0, Random.FRandRange(-180.0, 180.0), 0.0), Location);
+		}
+
+		TArray<FMassEntityHandle> Entities;
+		if (!MassShipSubsystem->SpawnShips(ShipClass, Transforms, Entities))
+		{
+			return;
+		}
+
+		for (const FMassEntityHandle Entity : Entities)
+		{
+			FSGSM_PilotInput PilotInput;
+			PilotInput.LinearThrust = FVector2D(1.0, 0.0);
+			PilotInput.AngularThrust = FVector2D(Random.FRandRange(-0.2, 0.2), 0.0);
+			MassShipSubsystem->SetShipInput(Entity, PilotInput);
+		}
+
+		UE_LOG(SMLogGeneric, Display, TEXT("Spawned %d Mass ships, %d in total"), Entities.Num(), MassShipSubsystem->GetNumEntityShips());
+	}));
@@ -0,0 +1,273 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_NiagaraDataInterfacePropulsion.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_RocketComponent.h"
+#include "SGSM_ThrustersComponent.h"
+#include "NiagaraSystemInstance.h"
+#include "NiagaraTypes.h"
+#include "GameFramework/Actor.h"
+
+#define LOCTEXT_NAMESPACE "SGSM_NiagaraDataInterfacePropulsion"
+
+namespace SGSM_NiagaraPropulsion
+{
+	static const FName GetShipThrustName(TEXT("GetShipThrust"));
+	static const FName GetNumRocketsName(TEXT("GetNumRockets"));
+	static const FName GetRocketThrustName(TEXT("GetRocketThrust"));
+	static const FName GetRocketMountName(TEXT("GetRocketMount"));
+
+	struct FRocketSample
+	{
+		FVector3f ThrustVector = FVector3f::ZeroVector;
+		FNiagaraPosition Location = FNiagaraPosition(FVector3f::ZeroVector);
+		FVector3f Direction = FVector3f::ForwardVector;
+		float Power = 0.f;
+		bool bThrusting = false;
+	};
+
+	/** Game thread copy of the ship output, the simulation only ever reads this. */
+	struct FInstanceData
+	{
+		TWeakObjectPtr<USGSM_PropulsionBrain> Brain;
+
+		FVector3f LinearThrustVector = FVector3f::ZeroVector;
+		FVector3f LinearThrustNormal = FVector3f::ZeroVector;
+		float BoostAmount = 0.f;
+		bool bBoosting = false;
+
+		TArray<FRocketSample> Rockets;
+	};
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		const ENiagaraTypeRegistryFlags Flags = ENiagaraTypeRegistryFlags::AllowAnyVariable | ENiagaraTypeRegistryFlags::AllowParameter;
+		FNiagaraTypeRegistry::Register(FNiagaraTypeDefinition(GetClass()), Flags);
+	}
+}
+
+#if WITH_EDITORONLY_DATA
+void USGSM_NiagaraDataInterfacePropulsion::GetFunctionsInternal(TArray<FNiagaraFunctionSignature>& OutFunctions) const
+{
+	using namespace SGSM_NiagaraPropulsion;
+
+	FNiagaraFunctionSignature BaseSignature;
+	BaseSignature.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition(GetClass()), TEXT("Propulsion")));
+	BaseSignature.bMemberFunction = true;
+	BaseSignature.bRequiresContext = false;
+	BaseSignature.bSupportsGPU = false;
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(BaseSignature);
+		Signature.Name = GetShipThrustName;
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("LinearThrust")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("LinearThrustNormal")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetBoolDef(), TEXT("Boosting")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetFloatDef(), TEXT("BoostAmount")));
+		Signature.SetDescription(LOCTEXT("GetShipThrustDescription", "World space thruster force in centinewtons, the same scaled by the max thrust of the ship, and the boost state."));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(BaseSignature);
+		Signature.Name = GetNumRocketsName;
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("NumRockets")));
+		Signature.SetDescription(LOCTEXT("GetNumRocketsDescription", "Number of rockets driven by the propulsion brain of the ship."));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(BaseSignature);
+		Signature.Name = GetRocketThrustName;
+		Signature.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("RocketIndex")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("ThrustVector")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetFloatDef(), TEXT("Power")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetBoolDef(), TEXT("Thrusting")));
+		Signature.SetDescription(LOCTEXT("GetRocketThrustDescription", "World space thrust applied by a rocket in the last physics step and its power between 0 and 1."));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(BaseSignature);
+		Signature.Name = GetRocketMountName;
+		Signature.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("RocketIndex")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetPositionDef(), TEXT("Location")));
+		Signature.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Direction")));
+		Signature.SetDescription(LOCTEXT("GetRocketMountDescription", "World location and thrust direction of a rocket."));
+	}
+}
+#endif
+
+void USGSM_NiagaraDataInterfacePropulsion::GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc)
+{
+	using namespace SGSM_NiagaraPropulsion;
+
+	if (BindingInfo.Name == GetShipThrustName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetShipThrust);
+	}
+	else if (BindingInfo.Name == GetNumRocketsName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetNumRockets);
+	}
+	else if (BindingInfo.Name == GetRocketThrustName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetRocketThrust);
+	}
+	else if (BindingInfo.Name == GetRocketMountName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetRocketMount);
+	}
+}
+
+int32 USGSM_NiagaraDataInterfacePropulsion::PerInstanceDataSize() const
+{
+	return sizeof(SGSM_NiagaraPropulsion::FInstanceData);
+}
+
+bool USGSM_NiagaraDataInterfacePropulsion::InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	SGSM_NiagaraPropulsion::FInstanceData* const InstanceData = new (PerInstanceData) SGSM_NiagaraPropulsion::FInstanceData();
+
+	const USceneComponent* const AttachComponent = SystemInstance ? SystemInstance->GetAttachComponent() : nullptr;
+	if (const AActor* const Owner = AttachComponent ? AttachComponent->GetOwner() : nullptr)
+	{
+		// Effects often sit on a module attached to the ship, the brain lives on the root.
+		InstanceData->Brain = Owner->GetAttachmentRootActor()->FindComponentByClass<USGSM_PropulsionBrain>();
+	}
+
+	return true;
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	static_cast<SGSM_NiagaraPropulsion::FInstanceData*>(PerInstanceData)->~FInstanceData();
+}
+
+bool USGSM_NiagaraDataInterfacePropulsion::PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds)
+{
+	using namespace SGSM_NiagaraPropulsion;
+
+	FInstanceData* const InstanceData = static_cast<FInstanceData*>(PerInstanceData);
+
+	const USGSM_PropulsionBrain* const Brain = InstanceData->Brain.Get();
+	if (!Brain)
+	{
+		InstanceData->LinearThrustVector = FVector3f::ZeroVector;
+		InstanceData->LinearThrustNormal = FVector3f::ZeroVector;
+		InstanceData->BoostAmount = 0.f;
+		InstanceData->bBoosting = false;
+		InstanceData->Rockets.Reset();
+		return false;
+	}
+
+	if (const USGSM_ThrustersComponent* const Thrusters = Brain->ThrustersComponent)
+	{
+		const FVector LinearThrustVector = Thrusters->GetLinearThrustVector();
+		const double MaxLinearCentinewtons = Thrusters->GetMaxLinearCentinewtons();
+
+		InstanceData->LinearThrustVector = FVector3f(LinearThrustVector);
+		InstanceData->LinearThrustNormal = MaxLinearCentinewtons > 0.0 ? FVector3f(LinearThrustVector / MaxLinearCentinewtons) : FVector3f::ZeroVector;
+		InstanceData->BoostAmount = static_cast<float>(Thrusters->GetBoostAmount());
+		InstanceData->bBoosting = Thrusters->IsBoosting();
+	}
+
+	const FNiagaraLWCConverter LWCConverter = SystemInstance->GetLWCConverter();
+
+	InstanceData->Rockets.SetNum(Brain->Rockets.Num(), EAllowShrinking::No);
+	for (int32 RocketIndex = 0; RocketIndex < Brain->Rockets.Num(); ++RocketIndex)
+	{
+		FRocketSample& Sample = InstanceData->Rockets[RocketIndex];
+
+		const USGSM_RocketComponent* const Rocket = Brain->Rockets[RocketIndex];
+		if (!Rocket)
+		{
+			Sample = FRocketSample();
+			continue;
+		}
+
+		const FVector ThrustVector = Rocket->GetCurrentThrustVector();
+		const double MaxThrustPower = Rocket->GetMaxThrustPower();
+
+		Sample.ThrustVector = FVector3f(ThrustVector);
+		Sample.Power = MaxThrustPower > 0.0 ? static_cast<float>(ThrustVector.Length() / MaxThrustPower) : 0.f;
+		Sample.bThrusting = Rocket->IsRocketThrusting();
+		Sample.Location = LWCConverter.ConvertWorldToSimulationPosition(Rocket->GetComponentLocation());
+		Sample.Direction = FVector3f(Rocket->GetForwardVector());
+	}
+
+	return false;
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::VMGetShipThrust(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<SGSM_NiagaraPropulsion::FInstanceData> InstanceData(Context);
+	FNDIOutputParam<FVector3f> OutLinearThrust(Context);
+	FNDIOutputParam<FVector3f> OutLinearThrustNormal(Context);
+	FNDIOutputParam<bool> OutBoosting(Context);
+	FNDIOutputParam<float> OutBoostAmount(Context);
+
+	for (int32 Index = 0; Index < Context.GetNumInstances(); ++Index)
+	{
+		OutLinearThrust.SetAndAdvance(InstanceData->LinearThrustVector);
+		OutLinearThrustNormal.SetAndAdvance(InstanceData->LinearThrustNormal);
+		OutBoosting.SetAndAdvance(InstanceData->bBoosting);
+		OutBoostAmount.SetAndAdvance(InstanceData->BoostAmount);
+	}
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::VMGetNumRockets(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<SGSM_NiagaraPropulsion::FInstanceData> InstanceData(Context);
+	FNDIOutputParam<int32> OutNumRockets(Context);
+
+	for (int32 Index = 0; Index < Context.GetNumInstances(); ++Index)
+	{
+		OutNumRockets.SetAndAdvance(InstanceData->Rockets.Num());
+	}
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::VMGetRocketThrust(FVectorVMExternalFunctionContext& Context)
+{
+	using namespace SGSM_NiagaraPropulsion;
+
+	VectorVM::FUserPtrHandler<FInstanceData> InstanceData(Context);
+	FNDIInputParam<int32> InRocketIndex(Context);
+	FNDIOutputParam<FVector3f> OutThrustVector(Context);
+	FNDIOutputParam<float> OutPower(Context);
+	FNDIOutputParam<bool> OutThrusting(Context);
+
+	static const FRocketSample NoRocket;
+
+	for (int32 Index = 0; Index < Context.GetNumInstances(); ++Index)
+	{
+		const int32 RocketIndex = InRocketIndex.GetAndAdvance();
+		const FRocketSample& Sample = InstanceData->Rockets.IsValidIndex(RocketIndex) ? InstanceData->Rockets[RocketIndex] : NoRocket;
+
+		OutThrustVector.SetAndAdvance(Sample.ThrustVector);
+		OutPower.SetAndAdvance(Sample.Power);
+		OutThrusting.SetAndAdvance(Sample.bThrusting);
+	}
+}
+
+void USGSM_NiagaraDataInterfacePropulsion::VMGetRocketMount(FVectorVMExternalFunctionContext& Context)
+{
+	using namespace SGSM_NiagaraPropulsion;
+
+	VectorVM::FUserPtrHandler<FInstanceData> InstanceData(Context);
+	FNDIInputParam<int32> InRocketIndex(Context);
+	FNDIOutputParam<FNiagaraPosition> OutLocation(Context);
+	FNDIOutputParam<FVector3f> OutDirection(Context);
+
+	static const FRocketSample NoRocket;
+
+	for (int32 Index = 0; Index < Context.GetNumInstances(); ++Index)
+	{
+		const int32 RocketIndex = InRocketIndex.GetAndAdvance();
+		const FRocketSample& Sample = InstanceData->Rockets.IsValidIndex(RocketIndex) ? InstanceData->Rockets[RocketIndex] : NoRocket;
+
+		OutLocation.SetAndAdvance(Sample.Location);
+		OutDirection.SetAndAdvance(Sample.Direction);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
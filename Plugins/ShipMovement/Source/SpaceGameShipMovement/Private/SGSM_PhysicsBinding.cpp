@@ -0,0 +1,36 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PhysicsBinding.h"
+#include "SGSM_LogCategory.h"
+#include "Components/PrimitiveComponent.h"
+
+
+void FSGSM_PhysicsBinding::Bind(const UPrimitiveComponent* InBody)
+{
+	const FBodyInstance* BI = InBody ? InBody->GetBodyInstance() : nullptr;
+
+	Proxy = BI ? BI->GetPhysicsActorHandle() : nullptr;
+	DebugName = GetFNameSafe(InBody);
+}
+
+void FSGSM_PhysicsBinding::Invalidate()
+{
+	Proxy = nullptr;
+}
+
+Chaos::FRigidBodyHandle_Internal* FSGSM_PhysicsBinding::Resolve()
+{
+	Chaos::FRigidBodyHandle_Internal* RigidBodyHandle = Proxy ? Proxy->GetPhysicsThreadAPI() : nullptr;
+
+	if (!RigidBodyHandle)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - LastMissingBodyLogTime >= MissingBodyLogInterval)
+		{
+			LastMissingBodyLogTime = Now;
+			UE_LOG(SMLogPropulsion, Warning, TEXT("Failed to get RigidBodyHandle of \"%s\", propulsion is skipped until its physics state is created."), *DebugName.ToString());
+		}
+	}
+
+	return RigidBodyHandle;
+}
@@ -0,0 +1,80 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PilotInput.h"
+
+
+namespace SGSM_PilotInput
+{
+	static int8 QuantizeAxis(double InValue)
+	{
+		return static_cast<int8>(FMath::RoundToInt(FMath::Clamp(InValue, -1.0, 1.0) * 127.0));
+	}
+
+	static double DequantizeAxis(int8 InValue)
+	{
+		return InValue / 127.0;
+	}
+}
+
+FSGSM_QuantizedPilotInput FSGSM_QuantizedPilotInput::Quantize(const FSGSM_PilotInput& InInput)
+{
+	FSGSM_QuantizedPilotInput Result;
+	Result.LinearX = SGSM_PilotInput::QuantizeAxis(InInput.LinearThrust.X);
+	Result.LinearY = SGSM_PilotInput::QuantizeAxis(InInput.LinearThrust.Y);
+	Result.AngularX = SGSM_PilotInput::QuantizeAxis(InInput.AngularThrust.X);
+	Result.AngularY = SGSM_PilotInput::QuantizeAxis(InInput.AngularThrust.Y);
+	Result.Boost = static_cast<uint8>(FMath::RoundToInt(FMath::Clamp(InInput.BoostValue, 0.f, 1.f) * 255.f));
+
+	Result.Flags = (InInput.bBoosting ? Boosting : 0)
+		| (InInput.bLinearBrake ? LinearBrake : 0)
+		| (InInput.bAngularBrake ? AngularBrake : 0)
+		| (InInput.bAlternativeTurning ? AlternativeTurning : 0);
+
+	return Result;
+}
+
+FSGSM_PilotInput FSGSM_QuantizedPilotInput::Dequantize() const
+{
+	FSGSM_PilotInput Result;
+	Result.LinearThrust = FVector2D(SGSM_PilotInput::DequantizeAxis(LinearX), SGSM_PilotInput::DequantizeAxis(LinearY));
+	Result.AngularThrust = FVector2D(SGSM_PilotInput::DequantizeAxis(AngularX), SGSM_PilotInput::DequantizeAxis(AngularY));
+	Result.BoostValue = Boost / 255.f;
+	Result.bBoosting = (Flags & Boosting) != 0;
+	Result.bLinearBrake = (Flags & LinearBrake) != 0;
+	Result.bAngularBrake = (Flags & AngularBrake) != 0;
+	Result.bAlternativeTurning = (Flags & AlternativeTurning) != 0;
+	return Result;
+}
+
+bool FSGSM_QuantizedPilotInput::HasSameInput(const FSGSM_QuantizedPilotInput& Other) const
+{
+	return LinearX == Other.LinearX
+		&& LinearY == Other.LinearY
+		&& AngularX == Other.AngularX
+		&& AngularY == Other.AngularY
+		&& Boost == Other.Boost
+		&& Flags == Other.Flags;
+}
+
+bool FSGSM_QuantizedPilotInput::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Sequence;
+	Ar << LinearX;
+	Ar << LinearY;
+	Ar << AngularX;
+	Ar << AngularY;
+
+	// Boost is only meaningful while boosting, skip the byte otherwise.
+	Ar.SerializeBits(&Flags, NumFlagBits);
+	if (Flags & Boosting)
+	{
+		Ar << Boost;
+	}
+	else if (Ar.IsLoading())
+	{
+		Boost = 0;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
@@ -3,14 +3,17 @@
 #include "SGSM_PropulsionBrain.h"
 #include "SGSM_ThrustersComponent.h"
 #include "SGSM_RocketComponent.h"
+#include "SGSM_PropulsionSubsystem.h"
 #include "SGSM_LogCategory.h"
+#include "SGSM_Stats.h"
+#include "Engine/AssetManager.h"
 
 
 USGSM_PropulsionBrain::USGSM_PropulsionBrain(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.TickGroup = TG_StartPhysics;
+	// Rocket activations are driven from input calls, a parked ship costs nothing on the game thread.
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 void USGSM_PropulsionBrain::BeginPlay()
@@ -23,50 +26,84 @@ void USGSM_PropulsionBrain::BeginPlay()
 	if (OwnerPawn)
 	{
 		ThrustersComponent = OwnerPawn->GetComponentByClass<USGSM_ThrustersComponent>();
-		if (ensureAlwaysMsgf(ThrustersComponent, TEXT("Failed to get Thrusters Component")))
-		{
-			ThrustersComponent->SetThrusterSpecifications(ThrusterSpecs);
-		}
+		ensureAlwaysMsgf(ThrustersComponent, TEXT("Failed to get Thrusters Component"));
 
-		TArray<USGSM_RocketComponent*> RocketComponents;
-		OwnerPawn->GetComponents<USGSM_RocketComponent>(RocketComponents, true);
+		// Before any rocket joins, so rockets already on the ship get the class data of a loaded class.
+		LoadShipClass();
+
+		PawnRootMesh = OwnerPawn->GetComponentByClass<UStaticMeshComponent>();
+		ensureAlwaysMsgf(PawnRootMesh, TEXT("Failed to get Static Mesh Component"));
 
-		for (USGSM_RocketComponent* const Rocket : RocketComponents)
+		// Rockets already on the ship are handed over right away, later ones as they attach.
+		PropulsionSubsystem = USGSM_PropulsionSubsystem::Get(this);
+		if (PropulsionSubsystem)
 		{
-			AddRocketComponent(Rocket);
+			Assembly = PropulsionSubsystem->RegisterBrain(this);
+
+			if (bBroadcastStatus)
+			{
+				PropulsionSubsystem->RegisterStatusBroadcast(this);
+			}
 		}
 
 		SetupRockets();
+	}
+}
 
-		PawnRootMesh = OwnerPawn->GetComponentByClass<UStaticMeshComponent>();
-		ensureAlwaysMsgf(PawnRootMesh, TEXT("Failed to get Static Mesh Component"));
+void USGSM_PropulsionBrain::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (ShipClassLoadHandle)
+	{
+		ShipClassLoadHandle->CancelHandle();
+		ShipClassLoadHandle.Reset();
+	}
+
+	if (PropulsionSubsystem)
+	{
+		PropulsionSubsystem->UnregisterStatusBroadcast(this);
+		PropulsionSubsystem->UnregisterBrain(this, Assembly);
+		PropulsionSubsystem = nullptr;
 	}
+	Assembly = nullptr;
+
+	Super::EndPlay(EndPlayReason);
 }
 
-double USGSM_PropulsionBrain::CalculateRocketEngagementValue(const USGSM_RocketComponent* InThruster, const FVector& InDirection)
+void USGSM_PropulsionBrain::OnAssemblyRocketJoined(USGSM_RocketComponent* InRocketComponent)
 {
-	if (!InThruster)
+	if (!InRocketComponent || Rockets.Contains(InRocketComponent))
 	{
-		return 0.0;
+		return;
 	}
 
-	const FVector F = InThruster->GetForwardVector();
-	const FVector R = (InDirection.Cross(F).Z < 0) ? InThruster->GetRightVector() : -InThruster->GetRightVector();
+	InRocketComponent->SetShipClassData(GetShipClassData());
+	AddRocketComponent(InRocketComponent);
+}
 
-	const FVector A = F - R;
-	const FVector B = InDirection;
-	const FVector C = B - R;
+void USGSM_PropulsionBrain::OnAssemblyRocketLeft(USGSM_RocketComponent* InRocketComponent)
+{
+	if (Rockets.Contains(InRocketComponent))
+	{
+		RemoveRocketComponent(InRocketComponent);
+	}
+}
 
-	double DotProduct = FVector::DotProduct(C, A);
-	double A_Squared = FVector::DotProduct(A, A);
+double USGSM_PropulsionBrain::CalculateRocketEngagementValue(const USGSM_RocketComponent* InThruster, const FVector& InDirection)
+{
+	if (!InThruster)
+	{
+		return 0.0;
+	}
 
-	const double t = FMath::Clamp(DotProduct / A_Squared, 0, 1);
+	using namespace SGSM_PropulsionMath;
 
-	return t;
+	return GetRocketEngagement(ToMath(InDirection), ToMath(InThruster->GetForwardVector()), ToMath(InThruster->GetRightVector()));
 }
 
 void USGSM_PropulsionBrain::TickLinearThrust(const FVector& InValue)
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (InValue.IsNearlyZero())
 	{
 		return;
@@ -82,6 +119,8 @@ void USGSM_PropulsionBrain::TickLinearThrust(const FVector& InValue)
 
 void USGSM_PropulsionBrain::EndLinearThrust()
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		LinearThrustDirection = FVector::ZeroVector;
@@ -91,6 +130,8 @@ void USGSM_PropulsionBrain::EndLinearThrust()
 
 void USGSM_PropulsionBrain::TickAngularThrust(const FVector& InValue)
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (InValue.IsNearlyZero())
 	{
 		return;
@@ -106,6 +147,8 @@ void USGSM_PropulsionBrain::TickAngularThrust(const FVector& InValue)
 
 void USGSM_PropulsionBrain::EndAngularThrust()
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		AngularThrustDirection = FVector::ZeroVector;
@@ -115,30 +158,34 @@ void USGSM_PropulsionBrain::EndAngularThrust()
 
 void USGSM_PropulsionBrain::TickBoosting(const float& InValue)
 {
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_TickBoosting);
+
+	OnPilotInputIssued.Broadcast(this);
+
+	BoostValue = InValue;
+
 	if (!OwnerPawn || Rockets.IsEmpty())
 	{
 		return;
 	}
 
-	for (USGSM_RocketComponent* const Rocket : Rockets)
-	{
-		if (!Rocket)
-		{
-			continue;
-		}
+	const bool bHasThrustDirection = LinearThrustDirection != FVector::ZeroVector;
+	const FVector Direction = bHasThrustDirection ? LinearThrustDirection : OwnerPawn->GetActorForwardVector();
+	const double DirectionScale = bHasThrustDirection ? LinearThrustDirection.Length() : 1.0;
 
-		double ActivationPercentage;
-		if (LinearThrustDirection != FVector::ZeroVector)
-		{
-			ActivationPercentage = CalculateRocketEngagementValue(Rocket, LinearThrustDirection) * LinearThrustDirection.Length();
-		}
-		else
-		{
-			ActivationPercentage = CalculateRocketEngagementValue(Rocket, OwnerPawn->GetActorForwardVector());
-		}
-		const double FinalThrustValue = InValue * ActivationPercentage;
+	// One transform into ship space for the whole rocket set.
+	const FQuat ShipRotation = OwnerPawn->GetActorQuat();
+	const FVector LocalDirection = ShipRotation.UnrotateVector(Direction);
 
-		Rocket->TickThrust(FMath::Clamp(FinalThrustValue, 0, 1));
+	if (bUseThrustAllocation && ThrustAllocator.IsValid())
+	{
+		ThrustAllocator.AllocateDirection(LocalDirection.GetSafeNormal(), InValue * DirectionScale, RocketActivations);
+		ApplyRocketActivations(ShipRotation, 1.0);
+	}
+	else
+	{
+		RocketLayout.CalculateEngagementValues(LocalDirection, RocketActivations);
+		ApplyRocketActivations(ShipRotation, InValue * DirectionScale);
 	}
 
 	if (ThrustersComponent)
@@ -151,8 +198,41 @@ void USGSM_PropulsionBrain::TickBoosting(const float& InValue)
 	}
 }
 
+void USGSM_PropulsionBrain::AllocateRocketThrust(const FVector& InForce, double InYawTorque)
+{
+	if (!OwnerPawn || !ThrustAllocator.IsValid())
+	{
+		return;
+	}
+
+	const FQuat ShipRotation = OwnerPawn->GetActorQuat();
+	ThrustAllocator.Allocate(ShipRotation.UnrotateVector(InForce), InYawTorque, RocketActivations);
+	ApplyRocketActivations(ShipRotation, 1.0);
+}
+
+void USGSM_PropulsionBrain::ApplyRocketActivations(const FQuat& InShipRotation, double InScale)
+{
+	for (int32 Index = 0; Index < RocketLayout.Num(); ++Index)
+	{
+		USGSM_RocketComponent* const Rocket = Rockets[RocketLayout.RocketIndex[Index]];
+		if (!Rocket)
+		{
+			continue;
+		}
+
+		const double FinalThrustValue = FMath::Clamp(InScale * RocketActivations[Index], 0, 1);
+
+		// The layout max thrust follows efficiency changes through NotifyEfficiencyChanged.
+		Rocket->TickThrustVector(InShipRotation.RotateVector(RocketLayout.LocalForward[Index]) * (RocketLayout.MaxThrust[Index] * FinalThrustValue));
+	}
+}
+
 void USGSM_PropulsionBrain::EndBoosting()
 {
+	OnPilotInputIssued.Broadcast(this);
+
+	BoostValue = 0.f;
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->SetBoosting(false);
@@ -183,6 +263,8 @@ bool USGSM_PropulsionBrain::IsBoosting() const
 
 void USGSM_PropulsionBrain::ToggleLinearBraking()
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->ToggleLinearBraking();
@@ -194,6 +276,8 @@ void USGSM_PropulsionBrain::ToggleLinearBraking()
 
 void USGSM_PropulsionBrain::SetLinearBraking(bool bIsEnabled)
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->SetLinearBraking(bIsEnabled);
@@ -213,6 +297,8 @@ bool USGSM_PropulsionBrain::IsLinearBraking() const
 
 void USGSM_PropulsionBrain::ToggleAngularBraking()
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->ToggleAngularBraking();
@@ -224,6 +310,8 @@ void USGSM_PropulsionBrain::ToggleAngularBraking()
 
 void USGSM_PropulsionBrain::SetAngularBraking(bool bIsEnabled)
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->SetAngularBraking(bIsEnabled);
@@ -243,6 +331,8 @@ bool USGSM_PropulsionBrain::IsAngularBraking() const
 
 void USGSM_PropulsionBrain::ToggleAltTurning()
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->ToggleAltTurning();
@@ -255,6 +345,8 @@ void USGSM_PropulsionBrain::ToggleAltTurning()
 
 void USGSM_PropulsionBrain::SetAlternativeTurning(bool bIsEnabled)
 {
+	OnPilotInputIssued.Broadcast(this);
+
 	if (ThrustersComponent)
 	{
 		ThrustersComponent->SetAlternativeTurning(bIsEnabled);
@@ -273,18 +365,150 @@ bool USGSM_PropulsionBrain::IsAlternativeTurning() const
 	return false;
 }
 
-void USGSM_PropulsionBrain::SetThrustersSpecifications(const FThrustersSpecifications& InThrustersSpecifications)
+FSGSM_PilotInput USGSM_PropulsionBrain::GetPilotInput() const
 {
-	ThrusterSpecs = InThrustersSpecifications;
-	if (ThrustersComponent)
+	FSGSM_PilotInput PilotInput;
+	PilotInput.LinearThrust = FVector2D(LinearThrustDirection);
+	PilotInput.AngularThrust = FVector2D(AngularThrustDirection);
+	PilotInput.BoostValue = BoostValue;
+	PilotInput.bBoosting = IsBoosting();
+	PilotInput.bLinearBrake = IsLinearBraking();
+	PilotInput.bAngularBrake = IsAngularBraking();
+	PilotInput.bAlternativeTurning = IsAlternativeTurning();
+	return PilotInput;
+}
+
+void USGSM_PropulsionBrain::ApplyPilotInput(const FSGSM_PilotInput& InPilotInput)
+{
+	// Alt-turning ends angular thrust, so it goes before the angular axis.
+	if (InPilotInput.bAlternativeTurning != IsAlternativeTurning())
 	{
-		ThrustersComponent->SetThrusterSpecifications(ThrusterSpecs);
+		SetAlternativeTurning(InPilotInput.bAlternativeTurning);
+	}
+
+	if (InPilotInput.bLinearBrake != IsLinearBraking())
+	{
+		SetLinearBraking(InPilotInput.bLinearBrake);
+	}
+
+	if (InPilotInput.bAngularBrake != IsAngularBraking())
+	{
+		SetAngularBraking(InPilotInput.bAngularBrake);
+	}
+
+	const FVector LinearThrust(InPilotInput.LinearThrust, 0.0);
+	if (!LinearThrust.IsNearlyZero())
+	{
+		TickLinearThrust(LinearThrust);
+	}
+	else if (!LinearThrustDirection.IsZero())
+	{
+		EndLinearThrust();
+	}
+
+	const FVector AngularThrust(InPilotInput.AngularThrust, 0.0);
+	if (!AngularThrust.IsNearlyZero())
+	{
+		TickAngularThrust(AngularThrust);
+	}
+	else if (!AngularThrustDirection.IsZero())
+	{
+		EndAngularThrust();
+	}
+
+	// Boost last, it steers the linear thrust direction while active.
+	if (InPilotInput.bBoosting)
+	{
+		TickBoosting(InPilotInput.BoostValue);
+	}
+	else if (IsBoosting())
+	{
+		EndBoosting();
 	}
 }
 
+void USGSM_PropulsionBrain::SetThrustersSpecifications(const FThrustersSpecifications& InThrustersSpecifications)
+{
+	ThrusterSpecs = InThrustersSpecifications;
+
+	// Specifications set at runtime are baked for this ship alone, on top of its current class data.
+	TSharedRef<FSGSM_ShipClassData> ClassData = MakeShared<FSGSM_ShipClassData>(BaseShipClassData ? *BaseShipClassData : FSGSM_ShipClassData::Empty);
+	ClassData->SetThrusterSpecifications(ThrusterSpecs);
+	SetBaseShipClassData(ClassData);
+}
+
 void USGSM_PropulsionBrain::SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications)
 {
 	RocketSpecs = InRocketSpecifications;
+
+	TSharedRef<FSGSM_ShipClassData> ClassData = MakeShared<FSGSM_ShipClassData>(BaseShipClassData ? *BaseShipClassData : FSGSM_ShipClassData::Empty);
+	ClassData->SetRocketSpecifications(RocketSpecs);
+	SetBaseShipClassData(ClassData);
+}
+
+void USGSM_PropulsionBrain::SetShipClass(USGSM_ShipClassDefinition* InShipClass)
+{
+	if (ShipClassLoadHandle)
+	{
+		ShipClassLoadHandle->CancelHandle();
+		ShipClassLoadHandle.Reset();
+	}
+
+	ShipClass = InShipClass;
+	LoadShipClass();
+}
+
+void USGSM_PropulsionBrain::SetShipClassOverrides(const FSGSM_ShipClassOverrides& InShipClassOverrides)
+{
+	ShipClassOverrides = InShipClassOverrides;
+	if (BaseShipClassData)
+	{
+		SetBaseShipClassData(BaseShipClassData.ToSharedRef());
+	}
+}
+
+void USGSM_PropulsionBrain::LoadShipClass()
+{
+	if (ShipClass.IsNull())
+	{
+		SetBaseShipClassData(FSGSM_ShipClassData::Make(ThrusterSpecs, RocketSpecs));
+		return;
+	}
+
+	if (USGSM_ShipClassDefinition* const LoadedShipClass = ShipClass.Get())
+	{
+		SetBaseShipClassData(LoadedShipClass->GetClassData());
+		return;
+	}
+
+	// The ship stays without thrust until its class arrives, classes are usually preloaded with the level.
+	ShipClassLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ShipClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &USGSM_PropulsionBrain::OnShipClassLoaded));
+}
+
+void USGSM_PropulsionBrain::OnShipClassLoaded()
+{
+	ShipClassLoadHandle.Reset();
+
+	USGSM_ShipClassDefinition* const LoadedShipClass = ShipClass.Get();
+	if (!LoadedShipClass)
+	{
+		UE_LOG(SMLogBrain, Error, TEXT("%s failed to load ship class %s"), *GetNameSafe(GetOwner()), *ShipClass.ToString());
+		return;
+	}
+
+	SetBaseShipClassData(LoadedShipClass->GetClassData());
+}
+
+void USGSM_PropulsionBrain::SetBaseShipClassData(const TSharedRef<const FSGSM_ShipClassData>& InClassData)
+{
+	BaseShipClassData = InClassData;
+	ShipClassData = ShipClassOverrides.Apply(InClassData);
+
+	if (ThrustersComponent)
+	{
+		ThrustersComponent->SetShipClassData(ShipClassData.ToSharedRef());
+	}
+
 	if (!Rockets.IsEmpty())
 	{
 		SetupRockets();
@@ -295,7 +519,19 @@ void USGSM_PropulsionBrain::AddRocketComponent(USGSM_RocketComponent* const NewR
 {
 	if (!Rockets.Contains(NewRocketComponent))
 	{
-		Rockets.Emplace(NewRocketComponent);
+		const int32 RocketIndex = Rockets.Emplace(NewRocketComponent);
+		if (NewRocketComponent)
+		{
+			NewRocketComponent->OnRocketAttachmentChanged.AddUObject(this, &ThisClass::OnRocketLayoutChanged);
+			NewRocketComponent->OnRocketEfficiencyChanged.AddUObject(this, &ThisClass::OnRocketLayoutChanged);
+		}
+
+		// Only the new rocket is captured, the other entries and allocator columns are left as they are.
+		if (OwnerPawn && NewRocketComponent)
+		{
+			RocketLayout.Add(RocketIndex, NewRocketComponent->GetComponentTransform().GetRelativeTransform(OwnerPawn->GetActorTransform()), NewRocketComponent->GetMaxThrustPower());
+			ThrustAllocator.AddRocket(RocketLayout, RocketLayout.Num() - 1);
+		}
 		UE_CLOG(GetWorld() && NewRocketComponent, SMLogBrain, Verbose, TEXT("\"%s\" Added Rocket Engine \"%s\" at: %s"), *GetFNameSafe(OwnerPawn).ToString(),
 			*GetFNameSafe(NewRocketComponent->GetOwner()).ToString(), *FString::SanitizeFloat(GetWorld()->GetRealTimeSeconds()));
 	}
@@ -308,9 +544,33 @@ void USGSM_PropulsionBrain::AddRocketComponent(USGSM_RocketComponent* const NewR
 
 void USGSM_PropulsionBrain::RemoveRocketComponent(USGSM_RocketComponent* const InRocketComponent)
 {
-	if (Rockets.Contains(InRocketComponent))
+	const int32 RocketIndex = Rockets.Find(InRocketComponent);
+	if (RocketIndex != INDEX_NONE)
 	{
-		Rockets.Remove(InRocketComponent);
+		const int32 Entry = RocketLayout.Find(RocketIndex);
+		if (Entry != INDEX_NONE)
+		{
+			RocketLayout.RemoveAtSwap(Entry);
+			ThrustAllocator.RemoveRocketAtSwap(Entry);
+		}
+
+		// The last rocket takes the freed slot, its layout entry follows it.
+		const int32 LastRocketIndex = Rockets.Num() - 1;
+		Rockets.RemoveAtSwap(RocketIndex, 1, EAllowShrinking::No);
+		if (RocketIndex != LastRocketIndex)
+		{
+			const int32 MovedEntry = RocketLayout.Find(LastRocketIndex);
+			if (MovedEntry != INDEX_NONE)
+			{
+				RocketLayout.RocketIndex[MovedEntry] = RocketIndex;
+			}
+		}
+
+		if (InRocketComponent)
+		{
+			InRocketComponent->OnRocketAttachmentChanged.RemoveAll(this);
+			InRocketComponent->OnRocketEfficiencyChanged.RemoveAll(this);
+		}
 		UE_CLOG(GetWorld() && InRocketComponent, SMLogBrain, Verbose, TEXT("\"%s\" Removed Rocket Engine \"%s\" at: %s"), *GetFNameSafe(OwnerPawn).ToString(),
 			*GetFNameSafe(InRocketComponent->GetOwner()).ToString(), *FString::SanitizeFloat(GetWorld()->GetRealTimeSeconds()));
 	}
@@ -329,9 +589,10 @@ double USGSM_PropulsionBrain::GetAverageRocketPower() const
 
 	for (USGSM_RocketComponent* const Rocket : Rockets)
 	{
-		if (!Rocket || Rocket->GetMaxThrustPower() <= 0.0) continue;
+		const double MaxThrustPower = Rocket ? Rocket->GetMaxThrustPower() : 0.0;
+		if (MaxThrustPower <= 0.0) continue;
 
-		Sum += Rocket->GetCurrentThrustPower() / Rocket->GetMaxThrustPower();
+		Sum += Rocket->GetCurrentThrustPower() / MaxThrustPower;
 	}
 
 	return Sum / Rockets.Num();
@@ -362,9 +623,49 @@ void USGSM_PropulsionBrain::SetupRockets()
 	{
 		if (Rocket)
 		{
-			Rocket->SetRocketSpecifications(RocketSpecs);
+			Rocket->SetShipClassData(GetShipClassData());
 		}
 	}
+
+	RebuildRocketLayout();
+}
+
+void USGSM_PropulsionBrain::RebuildRocketLayout()
+{
+	RocketLayout.Reset(Rockets.Num());
+	ThrustAllocator.Reset();
+
+	if (!OwnerPawn)
+	{
+		return;
+	}
+
+	const FTransform ShipTransform = OwnerPawn->GetActorTransform();
+
+	for (int32 Index = 0; Index < Rockets.Num(); ++Index)
+	{
+		if (const USGSM_RocketComponent* const Rocket = Rockets[Index])
+		{
+			RocketLayout.Add(Index, Rocket->GetComponentTransform().GetRelativeTransform(ShipTransform), Rocket->GetMaxThrustPower());
+		}
+	}
+
+	ThrustAllocator.Build(RocketLayout);
+}
+
+void USGSM_PropulsionBrain::OnRocketLayoutChanged(USGSM_RocketComponent* InRocketComponent)
+{
+	const int32 RocketIndex = Rockets.Find(InRocketComponent);
+	const int32 Entry = RocketLayout.Find(RocketIndex);
+	if (!OwnerPawn || !InRocketComponent || Entry == INDEX_NONE)
+	{
+		RebuildRocketLayout();
+		return;
+	}
+
+	// Only this rocket's mount or max thrust moved, the rest of the layout and the allocator columns still hold.
+	RocketLayout.Set(Entry, InRocketComponent->GetComponentTransform().GetRelativeTransform(OwnerPawn->GetActorTransform()), InRocketComponent->GetMaxThrustPower());
+	ThrustAllocator.UpdateRocket(RocketLayout, Entry);
 }
 
 FVector USGSM_PropulsionBrain::GetCurrentLinearThrustNormal() const
@@ -394,3 +695,124 @@ FVector USGSM_PropulsionBrain::GetCurrentLinearThrustNormal() const
 	}
 	return FVector::ZeroVector;
 }
+
+void USGSM_PropulsionBrain::SetBroadcastStatus(bool bInBroadcastStatus)
+{
+	if (bBroadcastStatus == bInBroadcastStatus)
+	{
+		return;
+	}
+
+	bBroadcastStatus = bInBroadcastStatus;
+	bHasBroadcastStatus = false;
+
+	if (PropulsionSubsystem)
+	{
+		if (bBroadcastStatus)
+		{
+			PropulsionSubsystem->RegisterStatusBroadcast(this);
+		}
+		else
+		{
+			PropulsionSubsystem->UnregisterStatusBroadcast(this);
+		}
+	}
+}
+
+namespace SGSM_PropulsionStatus
+{
+	/** Whether a value moved past its threshold since it was last broadcast, or reached or left zero. */
+	static bool HasMoved(double InValue, double InBroadcastValue, double InThreshold)
+	{
+		return (InValue == 0.0) != (InBroadcastValue == 0.0) || FMath::Abs(InValue - InBroadcastValue) >= InThreshold;
+	}
+
+	static bool HasMoved(const FVector& InValue, const FVector& InBroadcastValue, double InThreshold)
+	{
+		return InValue.IsZero() != InBroadcastValue.IsZero() || FVector::DistSquared(InValue, InBroadcastValue) >= FMath::Square(InThreshold);
+	}
+}
+
+void USGSM_PropulsionBrain::UpdatePropulsionStatus()
+{
+	using namespace SGSM_PropulsionStatus;
+
+	ESGSM_PropulsionStatusChange Changes = ESGSM_PropulsionStatusChange::None;
+
+	const FVector LinearThrustNormal = GetCurrentLinearThrustNormal();
+	if (HasMoved(LinearThrustNormal, PropulsionStatus.LinearThrustNormal, StatusThresholds.LinearThrust))
+	{
+		PropulsionStatus.LinearThrustNormal = LinearThrustNormal;
+		Changes |= ESGSM_PropulsionStatusChange::LinearThrust;
+	}
+
+	const float YawTorqueNormalized = ThrustersComponent ? static_cast<float>(ThrustersComponent->GetCurrentYawTorqueNormalized()) : 0.f;
+	if (HasMoved(YawTorqueNormalized, PropulsionStatus.YawTorqueNormalized, StatusThresholds.YawTorque))
+	{
+		PropulsionStatus.YawTorqueNormalized = YawTorqueNormalized;
+		Changes |= ESGSM_PropulsionStatusChange::YawTorque;
+	}
+
+	// Same as GetAverageRocketPower, but every rocket's efficiency is looked up once for both the rocket and the average.
+	if (PropulsionStatus.RocketPowers.Num() != Rockets.Num())
+	{
+		PropulsionStatus.RocketPowers.SetNumZeroed(Rockets.Num());
+		Changes |= ESGSM_PropulsionStatusChange::RocketPower;
+	}
+
+	double PowerSum = 0.0;
+	for (int32 RocketIndex = 0; RocketIndex < Rockets.Num(); ++RocketIndex)
+	{
+		const USGSM_RocketComponent* const Rocket = Rockets[RocketIndex];
+		const double MaxThrustPower = Rocket ? Rocket->GetMaxThrustPower() : 0.0;
+		const float RocketPower = MaxThrustPower > 0.0 ? static_cast<float>(Rocket->GetCurrentThrustPower() / MaxThrustPower) : 0.f;
+		PowerSum += RocketPower;
+
+		if (HasMoved(RocketPower, PropulsionStatus.RocketPowers[RocketIndex], StatusThresholds.RocketPower))
+		{
+			PropulsionStatus.RocketPowers[RocketIndex] = RocketPower;
+			Changes |= ESGSM_PropulsionStatusChange::RocketPower;
+		}
+	}
+
+	const float AverageRocketPower = Rockets.IsEmpty() ? 0.f : static_cast<float>(PowerSum / Rockets.Num());
+	if (HasMoved(AverageRocketPower, PropulsionStatus.AverageRocketPower, StatusThresholds.RocketPower))
+	{
+		PropulsionStatus.AverageRocketPower = AverageRocketPower;
+		Changes |= ESGSM_PropulsionStatusChange::RocketPower;
+	}
+
+	const bool bBoosting = IsBoosting();
+	if (bBoosting != PropulsionStatus.bBoosting)
+	{
+		PropulsionStatus.bBoosting = bBoosting;
+		Changes |= ESGSM_PropulsionStatusChange::Boosting;
+	}
+
+	const bool bLinearBraking = IsLinearBraking();
+	const bool bAngularBraking = IsAngularBraking();
+	if (bLinearBraking != PropulsionStatus.bLinearBraking || bAngularBraking != PropulsionStatus.bAngularBraking)
+	{
+		PropulsionStatus.bLinearBraking = bLinearBraking;
+		PropulsionStatus.bAngularBraking = bAngularBraking;
+		Changes |= ESGSM_PropulsionStatusChange::Braking;
+	}
+
+	// The first broadcast carries everything, listeners start from the full state.
+	if (!bHasBroadcastStatus)
+	{
+		bHasBroadcastStatus = true;
+		Changes = ESGSM_PropulsionStatusChange::LinearThrust | ESGSM_PropulsionStatusChange::YawTorque | ESGSM_PropulsionStatusChange::RocketPower
+			| ESGSM_PropulsionStatusChange::Boosting | ESGSM_PropulsionStatusChange::Braking;
+	}
+
+	if (Changes == ESGSM_PropulsionStatusChange::None)
+	{
+		return;
+	}
+
+	PropulsionStatus.Changes = static_cast<int32>(Changes);
+
+	OnPropulsionStatusChanged.Broadcast(this, PropulsionStatus);
+	BP_OnPropulsionStatusChanged.Broadcast(this, PropulsionStatus);
+}
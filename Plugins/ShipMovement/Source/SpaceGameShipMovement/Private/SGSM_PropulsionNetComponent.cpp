@@ -0,0 +1,181 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PropulsionNetComponent.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_RocketComponent.h"
+#include "SGSM_ThrustersComponent.h"
+#include "SGSM_LogCategory.h"
+#include "GameFramework/Pawn.h"
+#include "Net/UnrealNetwork.h"
+
+
+USGSM_PropulsionNetComponent::USGSM_PropulsionNetComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void USGSM_PropulsionNetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AActor* const Owner = GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	PropulsionBrain = Owner->GetComponentByClass<USGSM_PropulsionBrain>();
+	ensureAlwaysMsgf(PropulsionBrain, TEXT("Failed to get Propulsion Brain"));
+
+	// The pawn ticks its input first, the quantized input is sampled from the brain afterwards.
+	AddTickPrerequisiteActor(Owner);
+}
+
+bool USGSM_PropulsionNetComponent::IsLocallyControlled() const
+{
+	const APawn* const OwnerPawn = GetOwner<APawn>();
+	return OwnerPawn && OwnerPawn->IsLocallyControlled();
+}
+
+void USGSM_PropulsionNetComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!PropulsionBrain)
+	{
+		return;
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		UpdateShipState();
+	}
+
+	// Server side of a remotely piloted ship, the latest input is re-applied every frame as the brain steers against the current heading.
+	if (GetOwnerRole() == ROLE_Authority && bHasReceivedInput && !IsLocallyControlled())
+	{
+		PropulsionBrain->ApplyPilotInput(ReceivedInput.Dequantize());
+		return;
+	}
+
+	// Only remote owning clients send, the listen server host drives its brain directly.
+	if (GetOwnerRole() != ROLE_AutonomousProxy || !IsLocallyControlled())
+	{
+		return;
+	}
+
+	FSGSM_QuantizedPilotInput Input = FSGSM_QuantizedPilotInput::Quantize(PropulsionBrain->GetPilotInput());
+
+	// Predict with exactly what the server will receive.
+	PropulsionBrain->ApplyPilotInput(Input.Dequantize());
+
+	TimeSinceLastSend += DeltaTime;
+	if (bHasSentInput && Input.HasSameInput(LastSentInput) && TimeSinceLastSend < InputResendInterval)
+	{
+		return;
+	}
+
+	Input.Sequence = LastSentInput.Sequence + 1;
+	ServerSendPilotInput(Input);
+
+	LastSentInput = Input;
+	TimeSinceLastSend = 0.f;
+	bHasSentInput = true;
+}
+
+void USGSM_PropulsionNetComponent::ServerSendPilotInput_Implementation(const FSGSM_QuantizedPilotInput& InPilotInput)
+{
+	// Sequence numbers wrap, anything not ahead of the last one is a late unreliable packet.
+	if (bHasReceivedInput && static_cast<int16>(InPilotInput.Sequence - ReceivedInput.Sequence) <= 0)
+	{
+		return;
+	}
+
+	ReceivedInput = InPilotInput;
+	bHasReceivedInput = true;
+}
+
+void USGSM_PropulsionNetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner predicts its own ship and is corrected through physics replication.
+	DOREPLIFETIME_CONDITION(USGSM_PropulsionNetComponent, ShipState, COND_SkipOwner);
+}
+
+FSGSM_ShipStateSample USGSM_PropulsionNetComponent::SampleShipState() const
+{
+	FSGSM_ShipStateSample Sample;
+
+	const AActor* const Owner = GetOwner();
+	const UPrimitiveComponent* const Body = Owner ? Cast<UPrimitiveComponent>(Owner->GetRootComponent()) : nullptr;
+	if (Body)
+	{
+		Sample.Location = Body->GetComponentLocation();
+		Sample.LinearVelocity = Body->GetPhysicsLinearVelocity();
+		Sample.Yaw = Body->GetComponentRotation().Yaw;
+		Sample.YawRate = Body->GetPhysicsAngularVelocityInDegrees().Z;
+	}
+
+	const FVector LinearThrustNormal = PropulsionBrain->GetCurrentLinearThrustNormal();
+	Sample.LinearThrustNormal = FVector2D(LinearThrustNormal.X, LinearThrustNormal.Y);
+	Sample.YawTorqueNormalized = PropulsionBrain->ThrustersComponent ? PropulsionBrain->ThrustersComponent->GetCurrentYawTorqueNormalized() : 0.0;
+	Sample.AverageRocketPower = PropulsionBrain->GetAverageRocketPower();
+
+	Sample.RocketPowers.Reserve(PropulsionBrain->Rockets.Num());
+	for (const USGSM_RocketComponent* const Rocket : PropulsionBrain->Rockets)
+	{
+		const double MaxThrustPower = Rocket ? Rocket->GetMaxThrustPower() : 0.0;
+		Sample.RocketPowers.Add(MaxThrustPower > 0.0 ? Rocket->GetCurrentThrustPower() / MaxThrustPower : 0.f);
+	}
+
+	return Sample;
+}
+
+void USGSM_PropulsionNetComponent::UpdateShipState()
+{
+	// Unchanged quantized states keep their sequence and are not sent again.
+	ShipState.SetState(FSGSM_QuantizedShipState::Quantize(SampleShipState()));
+}
+
+void USGSM_PropulsionNetComponent::OnRep_ShipState()
+{
+	ReplicatedSample = ShipState.GetState().Dequantize();
+
+	if (!bApplyReplicatedStateToBody)
+	{
+		return;
+	}
+
+	AActor* const Owner = GetOwner();
+	UPrimitiveComponent* const Body = Owner ? Cast<UPrimitiveComponent>(Owner->GetRootComponent()) : nullptr;
+	if (!Body)
+	{
+		return;
+	}
+
+	FRotator Rotation = Body->GetComponentRotation();
+	Rotation.Yaw = ReplicatedSample.Yaw;
+	Body->SetWorldLocationAndRotation(ReplicatedSample.Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Body->SetPhysicsLinearVelocity(ReplicatedSample.LinearVelocity);
+	Body->SetPhysicsAngularVelocityInDegrees(FVector(0.0, 0.0, ReplicatedSample.YawRate));
+}
+
+FVector USGSM_PropulsionNetComponent::GetReplicatedLinearThrustNormal() const
+{
+	return FVector(ReplicatedSample.LinearThrustNormal, 0.0);
+}
+
+double USGSM_PropulsionNetComponent::GetReplicatedYawTorqueNormalized() const
+{
+	return ReplicatedSample.YawTorqueNormalized;
+}
+
+double USGSM_PropulsionNetComponent::GetReplicatedAverageRocketPower() const
+{
+	return ReplicatedSample.AverageRocketPower;
+}
@@ -0,0 +1,1075 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PropulsionSimCallback.h"
+#include "SGSM_KinematicPropulsion.h"
+#include "SGSM_LogCategory.h"
+#include "SGSM_Stats.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+
+static int32 GSGSM_ParallelShipThreshold = 64;
+static FAutoConsoleVariableRef CVarSGSM_ParallelShipThreshold(
+	TEXT("sgsm.Propulsion.ParallelShipThreshold"),
+	GSGSM_ParallelShipThreshold,
+	TEXT("Number of ships at which the batched propulsion step is split across worker threads."),
+	ECVF_Default);
+
+static int32 GSGSM_InputDelayFrames = 0;
+static FAutoConsoleVariableRef CVarSGSM_InputDelayFrames(
+	TEXT("sgsm.Propulsion.InputDelayFrames"),
+	GSGSM_InputDelayFrames,
+	TEXT("Number of physics frames input is held back before the propulsion step applies it."),
+	ECVF_Default);
+
+static int32 GSGSM_LODEnabled = 1;
+static FAutoConsoleVariableRef CVarSGSM_LODEnabled(
+	TEXT("sgsm.Propulsion.LOD.Enabled"),
+	GSGSM_LODEnabled,
+	TEXT("When enabled ships far from every player run the mid or far propulsion tier instead of the full rigid body model."),
+	ECVF_Default);
+
+static float GSGSM_LODMidDistance = 100000.f;
+static FAutoConsoleVariableRef CVarSGSM_LODMidDistance(
+	TEXT("sgsm.Propulsion.LOD.MidDistance"),
+	GSGSM_LODMidDistance,
+	TEXT("Distance to the nearest player, in cm, beyond which ships run the simplified controller at a reduced rate."),
+	ECVF_Default);
+
+static float GSGSM_LODFarDistance = 500000.f;
+static FAutoConsoleVariableRef CVarSGSM_LODFarDistance(
+	TEXT("sgsm.Propulsion.LOD.FarDistance"),
+	GSGSM_LODFarDistance,
+	TEXT("Distance to the nearest player, in cm, beyond which ships leave rigid body simulation and are integrated kinematically."),
+	ECVF_Default);
+
+static float GSGSM_LODHysteresis = 0.1f;
+static FAutoConsoleVariableRef CVarSGSM_LODHysteresis(
+	TEXT("sgsm.Propulsion.LOD.Hysteresis"),
+	GSGSM_LODHysteresis,
+	TEXT("Fraction of a tier distance a ship has to move past it before changing tier."),
+	ECVF_Default);
+
+static int32 GSGSM_LODMidStepInterval = 4;
+static FAutoConsoleVariableRef CVarSGSM_LODMidStepInterval(
+	TEXT("sgsm.Propulsion.LOD.MidStepInterval"),
+	GSGSM_LODMidStepInterval,
+	TEXT("Number of physics steps between controller updates of mid tier ships."),
+	ECVF_Default);
+
+static int32 GSGSM_DormancyEnabled = 1;
+static FAutoConsoleVariableRef CVarSGSM_DormancyEnabled(
+	TEXT("sgsm.Propulsion.Dormancy.Enabled"),
+	GSGSM_DormancyEnabled,
+	TEXT("When enabled ships without input that came to rest are skipped by the propulsion step and their body is left to sleep."),
+	ECVF_Default);
+
+static float GSGSM_DormancyLinearSpeed = 1.f;
+static FAutoConsoleVariableRef CVarSGSM_DormancyLinearSpeed(
+	TEXT("sgsm.Propulsion.Dormancy.LinearSpeed"),
+	GSGSM_DormancyLinearSpeed,
+	TEXT("Speed in cm/s below which a ship counts as at rest."),
+	ECVF_Default);
+
+static float GSGSM_DormancyAngularSpeed = 0.01f;
+static FAutoConsoleVariableRef CVarSGSM_DormancyAngularSpeed(
+	TEXT("sgsm.Propulsion.Dormancy.AngularSpeed"),
+	GSGSM_DormancyAngularSpeed,
+	TEXT("Angular speed in rad/s below which a ship counts as at rest."),
+	ECVF_Default);
+
+static int32 GSGSM_DormancySettleSteps = 30;
+static FAutoConsoleVariableRef CVarSGSM_DormancySettleSteps(
+	TEXT("sgsm.Propulsion.Dormancy.SettleSteps"),
+	GSGSM_DormancySettleSteps,
+	TEXT("Number of consecutive steps a ship without input has to stay at rest before it goes dormant."),
+	ECVF_Default);
+
+int32 FSGSM_PropulsionSimCallback::AllocateId(TArray<int32>& InOutIdToIndex, TArray<int32>& InOutFreeIds, int32 InIndex)
+{
+	const int32 Id = !InOutFreeIds.IsEmpty() ? InOutFreeIds.Pop(EAllowShrinking::No) : InOutIdToIndex.Add(INDEX_NONE);
+	InOutIdToIndex[Id] = InIndex;
+	return Id;
+}
+
+FSGSM_ShipHandle FSGSM_PropulsionSimCallback::FindShip(const UPrimitiveComponent* InBody) const
+{
+	for (const FSGSM_ShipState& Ship : Ships)
+	{
+		if (Ship.Body == InBody)
+		{
+			return FSGSM_ShipHandle{ Ship.Id };
+		}
+	}
+	return FSGSM_ShipHandle{};
+}
+
+FSGSM_ShipHandle FSGSM_PropulsionSimCallback::AddShipReference(UPrimitiveComponent* InBody, bool bInHasThrusters)
+{
+	if (!InBody)
+	{
+		return FSGSM_ShipHandle{};
+	}
+
+	FScopeLock Lock(&RegistryLock);
+
+	FSGSM_ShipHandle ShipHandle = FindShip(InBody);
+	if (!ShipHandle.IsValid())
+	{
+		const int32 Index = Ships.AddDefaulted();
+		FSGSM_ShipState& NewShip = Ships[Index];
+		NewShip.Body = InBody;
+		NewShip.Binding.Bind(InBody);
+		NewShip.OutputBuffer = MakeUnique<TSGSM_OutputBuffer<FSGSM_ShipOutputSnapshot>>();
+		NewShip.Id = AllocateId(ShipIdToIndex, FreeShipIds, Index);
+		ShipHandle.Id = NewShip.Id;
+	}
+
+	FSGSM_ShipState& Ship = Ships[ShipIdToIndex[ShipHandle.Id]];
+	Ship.NumReferences++;
+
+	if (bInHasThrusters && !Ship.bHasThrusters)
+	{
+		Ship.bHasThrusters = true;
+		Ship.Thrusters.InputChannel = MakeUnique<TSGSM_InputChannel<FSGSM_ThrusterInputSnapshot>>();
+	}
+
+	return ShipHandle;
+}
+
+UPrimitiveComponent* FSGSM_PropulsionSimCallback::RemoveShipReference(FSGSM_ShipHandle InShipHandle, bool bInHasThrusters)
+{
+	FScopeLock Lock(&RegistryLock);
+
+	if (!ShipIdToIndex.IsValidIndex(InShipHandle.Id) || ShipIdToIndex[InShipHandle.Id] == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	const int32 Index = ShipIdToIndex[InShipHandle.Id];
+	FSGSM_ShipState& Ship = Ships[Index];
+
+	if (bInHasThrusters)
+	{
+		Ship.bHasThrusters = false;
+		Ship.Thrusters = FSGSM_ThrusterState();
+	}
+
+	if (--Ship.NumReferences > 0)
+	{
+		return nullptr;
+	}
+
+	// Hand the body back to Chaos with its current velocities.
+	if (Ship.bSimulationSuspendedByLOD && IsValid(Ship.Body))
+	{
+		SetShipLOD(Ship, ESGSM_PropulsionLOD::Near);
+	}
+
+	UPrimitiveComponent* const RemovedBody = Ship.Body;
+
+	ShipIdToIndex[InShipHandle.Id] = INDEX_NONE;
+	FreeShipIds.Add(InShipHandle.Id);
+
+	Ships.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Ships.IsValidIndex(Index))
+	{
+		ShipIdToIndex[Ships[Index].Id] = Index;
+	}
+
+	return RemovedBody;
+}
+
+void FSGSM_PropulsionSimCallback::RebindShip(const UPrimitiveComponent* InBody)
+{
+	FScopeLock Lock(&RegistryLock);
+
+	for (FSGSM_ShipState& Ship : Ships)
+	{
+		if (Ship.Body == InBody)
+		{
+			Ship.Binding.Bind(InBody);
+		}
+	}
+}
+
+FSGSM_RocketHandle FSGSM_PropulsionSimCallback::AddRocket(UPrimitiveComponent* InBody)
+{
+	const FSGSM_ShipHandle ShipHandle = AddShipReference(InBody, false);
+	if (!ShipHandle.IsValid())
+	{
+		return FSGSM_RocketHandle{};
+	}
+
+	FScopeLock Lock(&RegistryLock);
+
+	const int32 Index = Rockets.AddDefaulted();
+	FSGSM_RocketState& Rocket = Rockets[Index];
+	Rocket.Id = AllocateId(RocketIdToIndex, FreeRocketIds, Index);
+	Rocket.ShipId = ShipHandle.Id;
+	Rocket.InputChannel = MakeUnique<TSGSM_InputChannel<FSGSM_RocketInputSnapshot>>();
+	Rocket.OutputBuffer = MakeUnique<TSGSM_OutputBuffer<FSGSM_RocketOutputSnapshot>>();
+
+	Ships[ShipIdToIndex[ShipHandle.Id]].RocketIds.Add(Rocket.Id);
+
+	return FSGSM_RocketHandle{ Rocket.Id };
+}
+
+UPrimitiveComponent* FSGSM_PropulsionSimCallback::RemoveRocket(FSGSM_RocketHandle InRocketHandle)
+{
+	FSGSM_ShipHandle ShipHandle;
+	{
+		FScopeLock Lock(&RegistryLock);
+
+		if (!RocketIdToIndex.IsValidIndex(InRocketHandle.Id) || RocketIdToIndex[InRocketHandle.Id] == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		const int32 Index = RocketIdToIndex[InRocketHandle.Id];
+		ShipHandle.Id = Rockets[Index].ShipId;
+
+		if (FSGSM_ShipState* Ship = GetShipState(ShipHandle))
+		{
+			Ship->RocketIds.RemoveSingleSwap(InRocketHandle.Id, EAllowShrinking::No);
+		}
+
+		RocketIdToIndex[InRocketHandle.Id] = INDEX_NONE;
+		FreeRocketIds.Add(InRocketHandle.Id);
+
+		Rockets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		if (Rockets.IsValidIndex(Index))
+		{
+			RocketIdToIndex[Rockets[Index].Id] = Index;
+		}
+	}
+
+	return RemoveShipReference(ShipHandle, false);
+}
+
+void FSGSM_PropulsionSimCallback::SetThrusterSpecs(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterSpecs& InSpecs)
+{
+	FScopeLock Lock(&RegistryLock);
+
+	if (FSGSM_ShipState* Ship = GetShipState(InShipHandle))
+	{
+		Ship->Thrusters.Specs = InSpecs;
+	}
+}
+
+template <typename SnapshotType>
+void FSGSM_PropulsionSimCallback::StampInput(SnapshotType& InOutSnapshot) const
+{
+	InOutSnapshot.IssuedFrame = PhysicsFrame.load(std::memory_order_acquire);
+	InOutSnapshot.TargetFrame = InOutSnapshot.IssuedFrame + 1 + FMath::Max(GSGSM_InputDelayFrames, 0);
+}
+
+void FSGSM_PropulsionSimCallback::PushThrusterInput(FSGSM_ShipHandle InShipHandle, FSGSM_ThrusterInputSnapshot InSnapshot)
+{
+	check(IsInGameThread());
+
+	FSGSM_ShipState* Ship = GetShipState(InShipHandle);
+	if (Ship && Ship->Thrusters.InputChannel)
+	{
+		StampInput(InSnapshot);
+		Ship->Thrusters.InputChannel->Push(InSnapshot);
+	}
+}
+
+void FSGSM_PropulsionSimCallback::PushRocketInput(FSGSM_RocketHandle InRocketHandle, FSGSM_RocketInputSnapshot InSnapshot)
+{
+	check(IsInGameThread());
+
+	FSGSM_RocketState* Rocket = GetRocketState(InRocketHandle);
+	if (Rocket && Rocket->InputChannel)
+	{
+		StampInput(InSnapshot);
+		Rocket->InputChannel->Push(InSnapshot);
+	}
+}
+
+void FSGSM_PropulsionSimCallback::FlushPendingInputs()
+{
+	check(IsInGameThread());
+
+	for (FSGSM_ShipState& Ship : Ships)
+	{
+		if (Ship.Thrusters.InputChannel)
+		{
+			Ship.Thrusters.InputChannel->Flush();
+		}
+	}
+
+	for (FSGSM_RocketState& Rocket : Rockets)
+	{
+		Rocket.InputChannel->Flush();
+	}
+}
+
+const FSGSM_ShipOutputSnapshot* FSGSM_PropulsionSimCallback::ReadShipOutput(FSGSM_ShipHandle InShipHandle)
+{
+	check(IsInGameThread());
+
+	const FSGSM_ShipState* Ship = GetShipState(InShipHandle);
+	return Ship ? &Ship->OutputBuffer->ReadLatest() : nullptr;
+}
+
+const FSGSM_RocketOutputSnapshot* FSGSM_PropulsionSimCallback::ReadRocketOutput(FSGSM_RocketHandle InRocketHandle)
+{
+	check(IsInGameThread());
+
+	const FSGSM_RocketState* Rocket = GetRocketState(InRocketHandle);
+	return Rocket ? &Rocket->OutputBuffer->ReadLatest() : nullptr;
+}
+
+void FSGSM_PropulsionSimCallback::SetCaptureStepTimings(bool bInCapture)
+{
+	bCaptureStepTimings.store(bInCapture, std::memory_order_relaxed);
+}
+
+void FSGSM_PropulsionSimCallback::DrainStepTimings(TArray<double>& OutSeconds)
+{
+	FScopeLock Lock(&RegistryLock);
+
+	OutSeconds.Append(StepTimings);
+	StepTimings.Reset();
+}
+
+ESGSM_PropulsionLOD FSGSM_PropulsionSimCallback::GetShipLOD(FSGSM_ShipHandle InShipHandle)
+{
+	const FSGSM_ShipState* Ship = GetShipState(InShipHandle);
+	return Ship ? Ship->LOD : ESGSM_PropulsionLOD::Near;
+}
+
+void FSGSM_PropulsionSimCallback::UpdateLOD(TConstArrayView<FVector> InViewpoints)
+{
+	check(IsInGameThread());
+
+	// Tiers are picked under the lock like every other registry read, bodies are switched after releasing it.
+	TArray<TPair<int32, ESGSM_PropulsionLOD>, TInlineAllocator<16>> LODChanges;
+	{
+		FScopeLock Lock(&RegistryLock);
+
+		for (int32 Index = 0; Index < Ships.Num(); ++Index)
+		{
+			const FSGSM_ShipState& Ship = Ships[Index];
+
+			// Without anyone to look at them, ships keep the full model.
+			const ESGSM_PropulsionLOD LOD = GSGSM_LODEnabled && IsValid(Ship.Body) && !InViewpoints.IsEmpty() ? PickLOD(Ship, InViewpoints) : ESGSM_PropulsionLOD::Near;
+			if (LOD != Ship.LOD)
+			{
+				LODChanges.Emplace(Index, LOD);
+			}
+		}
+	}
+
+	// Ships are only added and removed on the game thread, the indices still hold.
+	for (const TPair<int32, ESGSM_PropulsionLOD>& Change : LODChanges)
+	{
+		SetShipLOD(Ships[Change.Key], Change.Value);
+	}
+}
+
+ESGSM_PropulsionLOD FSGSM_PropulsionSimCallback::PickLOD(const FSGSM_ShipState& InShip, TConstArrayView<FVector> InViewpoints) const
+{
+	const FVector Location = InShip.Body->GetComponentLocation();
+
+	double MinDistanceSquared = UE_BIG_NUMBER;
+	for (const FVector& Viewpoint : InViewpoints)
+	{
+		MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(Location, Viewpoint));
+	}
+	const double Distance = FMath::Sqrt(MinDistanceSquared);
+
+	// A ship has to move past the boundary by the hysteresis before it changes tier, so ships on it do not flip every frame.
+	const auto IsBeyond = [&InShip, Distance](double InTierDistance, ESGSM_PropulsionLOD InTier)
+	{
+		const double Bias = InShip.LOD >= InTier ? 1.0 - GSGSM_LODHysteresis : 1.0 + GSGSM_LODHysteresis;
+		return Distance > InTierDistance * Bias;
+	};
+
+	if (IsBeyond(GSGSM_LODFarDistance, ESGSM_PropulsionLOD::Far))
+	{
+		return ESGSM_PropulsionLOD::Far;
+	}
+	if (IsBeyond(GSGSM_LODMidDistance, ESGSM_PropulsionLOD::Mid))
+	{
+		return ESGSM_PropulsionLOD::Mid;
+	}
+	return ESGSM_PropulsionLOD::Near;
+}
+
+void FSGSM_PropulsionSimCallback::SetShipLOD(FSGSM_ShipState& InShip, ESGSM_PropulsionLOD InLOD)
+{
+	check(IsInGameThread());
+
+	UPrimitiveComponent* const Body = InShip.Body;
+
+	// Only bodies that actually simulate can be handed over to the kinematic integrator. Replicated bodies keep simulating,
+	// physics replication corrects them through the solver and cannot follow a body that stopped simulating.
+	const AActor* const Owner = Body->GetOwner();
+	const bool bReplicatedBody = Owner && Owner->IsReplicatingMovement() && Owner->GetNetMode() != NM_Standalone;
+	if (InLOD == ESGSM_PropulsionLOD::Far && !InShip.bSimulationSuspendedByLOD && (!Body->IsSimulatingPhysics() || bReplicatedBody))
+	{
+		InLOD = ESGSM_PropulsionLOD::Mid;
+		if (InLOD == InShip.LOD)
+		{
+			return;
+		}
+	}
+
+	if (InLOD == ESGSM_PropulsionLOD::Far)
+	{
+		FSGSM_KinematicBody Kinematic;
+		Kinematic.Location = Body->GetComponentLocation();
+		Kinematic.Rotation = Body->GetComponentQuat();
+		Kinematic.LinearVelocity = Body->GetPhysicsLinearVelocity();
+		Kinematic.AngularVelocity = Body->GetPhysicsAngularVelocityInRadians();
+		Kinematic.CenterOfMass = Body->GetComponentTransform().InverseTransformPositionNoScale(Body->GetCenterOfMass());
+		Kinematic.Mass = FMath::Max(Body->GetMass(), UE_KINDA_SMALL_NUMBER);
+		Kinematic.Inertia = FMath::Max(Body->GetInertiaTensor().GetMax(), UE_KINDA_SMALL_NUMBER);
+
+		Body->SetSimulatePhysics(false);
+		InShip.bSimulationSuspendedByLOD = true;
+
+		FScopeLock Lock(&RegistryLock);
+		InShip.Kinematic = Kinematic;
+		InShip.LOD = InLOD;
+		return;
+	}
+
+	FSGSM_KinematicBody Kinematic;
+	{
+		FScopeLock Lock(&RegistryLock);
+		Kinematic = InShip.Kinematic;
+		InShip.LOD = InLOD;
+		InShip.CachedForce = FVector::ZeroVector;
+		InShip.CachedTorque = FVector::ZeroVector;
+		InShip.NextControllerFrame = 0;
+	}
+
+	if (InShip.bSimulationSuspendedByLOD)
+	{
+		// Resume from exactly where the integrator left the ship, with its velocities.
+		Body->SetWorldLocationAndRotation(Kinematic.Location, Kinematic.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		Body->SetSimulatePhysics(true);
+		Body->SetPhysicsLinearVelocity(Kinematic.LinearVelocity);
+		Body->SetPhysicsAngularVelocityInRadians(Kinematic.AngularVelocity);
+		InShip.bSimulationSuspendedByLOD = false;
+	}
+}
+
+void FSGSM_PropulsionSimCallback::ApplyKinematicOutputs()
+{
+	check(IsInGameThread());
+
+	for (FSGSM_ShipState& Ship : Ships)
+	{
+		if (Ship.LOD != ESGSM_PropulsionLOD::Far || !Ship.bSimulationSuspendedByLOD || !IsValid(Ship.Body))
+		{
+			continue;
+		}
+
+		const FSGSM_ShipOutputSnapshot& Output = Ship.OutputBuffer->ReadLatest();
+		if (!Output.bKinematic)
+		{
+			continue;
+		}
+
+		Ship.Body->SetWorldLocationAndRotation(Output.Kinematic.Location, Output.Kinematic.Rotation);
+		Ship.Body->ComponentVelocity = Output.Kinematic.LinearVelocity;
+	}
+}
+
+FSGSM_ShipState* FSGSM_PropulsionSimCallback::GetShipState(FSGSM_ShipHandle InShipHandle)
+{
+	if (!ShipIdToIndex.IsValidIndex(InShipHandle.Id))
+	{
+		return nullptr;
+	}
+
+	const int32 Index = ShipIdToIndex[InShipHandle.Id];
+	return Ships.IsValidIndex(Index) ? &Ships[Index] : nullptr;
+}
+
+FSGSM_RocketState* FSGSM_PropulsionSimCallback::GetRocketState(FSGSM_RocketHandle InRocketHandle)
+{
+	if (!RocketIdToIndex.IsValidIndex(InRocketHandle.Id))
+	{
+		return nullptr;
+	}
+
+	const int32 Index = RocketIdToIndex[InRocketHandle.Id];
+	return Rockets.IsValidIndex(Index) ? &Rockets[Index] : nullptr;
+}
+
+void FSGSM_PropulsionSimCallback::OnPreSimulate_Internal()
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PropulsionStep);
+
+	const float DeltaTime = GetDeltaTime_Internal();
+	const int32 CurrentFrame = PhysicsFrame.load(std::memory_order_relaxed) + 1;
+
+	FScopeLock Lock(&RegistryLock);
+
+	const bool bCaptureTiming = bCaptureStepTimings.load(std::memory_order_relaxed);
+	const uint64 StartCycles = bCaptureTiming ? FPlatformTime::Cycles64() : 0;
+
+	const bool bSingleThreaded = Ships.Num() < GSGSM_ParallelShipThreshold;
+
+	FStepCounters Counters;
+
+	// Rockets are stepped together with the ship they push, so every body is only ever touched by one worker.
+	ParallelFor(Ships.Num(), [this, CurrentFrame, DeltaTime, &Counters](int32 Index)
+	{
+		StepShip(Ships[Index], CurrentFrame, DeltaTime, Counters);
+	}, bSingleThreaded);
+
+	PhysicsFrame.store(CurrentFrame, std::memory_order_release);
+
+	if (bCaptureTiming)
+	{
+		StepTimings.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+
+	SET_DWORD_STAT(STAT_SGSM_ActiveShips, Counters.ActiveShips.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_MidShips, Counters.MidShips.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_FarShips, Counters.FarShips.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_DormantShips, Counters.DormantShips.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_BrakingShips, Counters.BrakingShips.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_FiringRockets, Counters.FiringRockets.load(std::memory_order_relaxed));
+	SET_DWORD_STAT(STAT_SGSM_InputLatencyFrames, Counters.MaxInputLatencyFrames.load(std::memory_order_relaxed));
+}
+
+void FSGSM_PropulsionSimCallback::StepShip(FSGSM_ShipState& InShip, int32 InPhysicsFrame, float DeltaTime, FStepCounters& InOutCounters)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_StepShip);
+
+	// Input is consumed even when the body is missing so the channels never back up.
+	ConsumeInputs(InShip, InPhysicsFrame, InOutCounters);
+
+	// Resolved once per step and shared by every thruster and rocket path of this ship.
+	Chaos::FRigidBodyHandle_Internal* const RigidBodyHandle = InShip.LOD != ESGSM_PropulsionLOD::Far ? InShip.Binding.Resolve() : nullptr;
+
+	if (InShip.bDormant)
+	{
+		if (!ShouldWake(InShip, RigidBodyHandle))
+		{
+#if STATS
+			InOutCounters.DormantShips.fetch_add(1, std::memory_order_relaxed);
+#endif
+			return;
+		}
+
+		InShip.bDormant = false;
+		InShip.SettledSteps = 0;
+		InShip.NextControllerFrame = InPhysicsFrame;
+	}
+
+	FSGSM_ShipOutputSnapshot Output;
+	Output.Frame = InPhysicsFrame;
+
+	if (InShip.LOD == ESGSM_PropulsionLOD::Far)
+	{
+		IntegrateKinematic(InShip, DeltaTime, InOutCounters, Output);
+	}
+	else if (RigidBodyHandle)
+	{
+		const Chaos::EObjectStateType ObjectState = RigidBodyHandle->ObjectState();
+		if (ObjectState == Chaos::EObjectStateType::Dynamic || ObjectState == Chaos::EObjectStateType::Sleeping)
+		{
+			if (InShip.LOD == ESGSM_PropulsionLOD::Mid)
+			{
+				ApplySimplifiedPropulsion(InShip, *RigidBodyHandle, InPhysicsFrame, DeltaTime, InOutCounters, Output);
+			}
+			else
+			{
+				ApplyPropulsion(InShip, *RigidBodyHandle, DeltaTime, InOutCounters, Output);
+			}
+		}
+	}
+
+	UpdateDormancy(InShip, RigidBodyHandle, Output);
+
+	PublishOutputs(InShip, Output);
+}
+
+bool FSGSM_PropulsionSimCallback::HasActiveInput(const FSGSM_ShipState& InShip) const
+{
+	if (InShip.bHasThrusters)
+	{
+		const FSGSM_ThrusterInputSnapshot& Input = InShip.Thrusters.Input;
+		if (!Input.LinearThrustDirection.IsNearlyZero() || !Input.AngularThrustDirection.IsNearlyZero() || Input.bBoosting)
+		{
+			return true;
+		}
+	}
+
+	for (const int32 RocketId : InShip.RocketIds)
+	{
+		if (Rockets[RocketIdToIndex[RocketId]].Input.bRocketThrusting)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FSGSM_PropulsionSimCallback::IsAtRest(const FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody)
+{
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+
+	if (InShip.LOD == ESGSM_PropulsionLOD::Far)
+	{
+		LinearVelocity = InShip.Kinematic.LinearVelocity;
+		AngularVelocity = InShip.Kinematic.AngularVelocity;
+	}
+	else if (InRigidBody)
+	{
+		if (InRigidBody->ObjectState() == Chaos::EObjectStateType::Sleeping)
+		{
+			return true;
+		}
+
+		LinearVelocity = InRigidBody->GetV();
+		AngularVelocity = InRigidBody->GetW();
+	}
+	else
+	{
+		return true;
+	}
+
+	return LinearVelocity.SizeSquared() <= FMath::Square(GSGSM_DormancyLinearSpeed)
+		&& AngularVelocity.SizeSquared() <= FMath::Square(GSGSM_DormancyAngularSpeed);
+}
+
+bool FSGSM_PropulsionSimCallback::ShouldWake(const FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody) const
+{
+	return !GSGSM_DormancyEnabled || HasActiveInput(InShip) || !IsAtRest(InShip, InRigidBody);
+}
+
+void FSGSM_PropulsionSimCallback::UpdateDormancy(FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody, FSGSM_ShipOutputSnapshot& InOutOutput) const
+{
+	if (!GSGSM_DormancyEnabled || HasActiveInput(InShip) || !IsAtRest(InShip, InRigidBody))
+	{
+		InShip.SettledSteps = 0;
+		return;
+	}
+
+	if (++InShip.SettledSteps < FMath::Max(GSGSM_DormancySettleSteps, 1))
+	{
+		return;
+	}
+
+	// Nothing touches the body from now on, so Chaos is free to put it to sleep.
+	InShip.bDormant = true;
+	InShip.CachedForce = FVector::ZeroVector;
+	InShip.CachedTorque = FVector::ZeroVector;
+	InOutOutput.bDormant = true;
+}
+
+void FSGSM_PropulsionSimCallback::ConsumeInputs(FSGSM_ShipState& InShip, int32 InPhysicsFrame, FStepCounters& InOutCounters)
+{
+	const FSGSM_ThrusterInputSnapshot PreviousInput = InShip.Thrusters.Input;
+	if (InShip.bHasThrusters && InShip.Thrusters.InputChannel->ConsumeLatest(InPhysicsFrame, InShip.Thrusters.Input))
+	{
+		// The mid tier wrench was solved for the previous input, it is solved again this step.
+		if (!InShip.Thrusters.Input.HasSameInput(PreviousInput))
+		{
+			InShip.NextControllerFrame = InPhysicsFrame;
+		}
+
+#if STATS
+		const int32 Latency = InPhysicsFrame - InShip.Thrusters.Input.IssuedFrame;
+		int32 MaxLatency = InOutCounters.MaxInputLatencyFrames.load(std::memory_order_relaxed);
+		while (Latency > MaxLatency && !InOutCounters.MaxInputLatencyFrames.compare_exchange_weak(MaxLatency, Latency, std::memory_order_relaxed))
+		{
+		}
+#endif
+	}
+
+	for (const int32 RocketId : InShip.RocketIds)
+	{
+		FSGSM_RocketState& Rocket = Rockets[RocketIdToIndex[RocketId]];
+		Rocket.InputChannel->ConsumeLatest(InPhysicsFrame, Rocket.Input);
+		Rocket.AppliedThrustVector = FVector::ZeroVector;
+	}
+}
+
+void FSGSM_PropulsionSimCallback::ApplyPropulsion(FSGSM_ShipState& InShip, Chaos::FRigidBodyHandle_Internal& InRigidBody, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput)
+{
+#if STATS
+	InOutCounters.ActiveShips.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	// Everything thrusters and rockets produce this step, applied to the body in one go at the end.
+	FWrench Wrench;
+
+	if (InShip.bHasThrusters)
+	{
+		FSGSM_ThrusterState& Thrusters = InShip.Thrusters;
+
+		// Ending thrust resets the active state so the brakes engage again from this step on.
+		if (Thrusters.Input.LinearThrustDirection.IsNearlyZero())
+		{
+			Thrusters.bLinearThrustActive = false;
+			Thrusters.LinearThrustVector = FVector::ZeroVector;
+		}
+
+		if (Thrusters.Input.AngularThrustDirection.IsNearlyZero())
+		{
+			Thrusters.bAngularThrustActive = false;
+			Thrusters.CurrentYawTorque = 0.0;
+		}
+
+#if STATS
+		if (Thrusters.Input.bLinearBrake || Thrusters.Input.bAngularBrake)
+		{
+			InOutCounters.BrakingShips.fetch_add(1, std::memory_order_relaxed);
+		}
+#endif
+
+		if (Thrusters.Input.bLinearBrake && !Thrusters.bLinearThrustActive)
+		{
+			PhysicsTickLinearBrake(InRigidBody, Thrusters, Wrench, DeltaTime);
+			OutOutput.bLinearBraking = true;
+		}
+
+		if (!Thrusters.Input.LinearThrustDirection.IsNearlyZero())
+		{
+			PhysicsTickLinearThrust(InRigidBody, Thrusters, Wrench, DeltaTime);
+		}
+
+		if (Thrusters.Input.bAngularBrake && !Thrusters.bAngularThrustActive)
+		{
+			PhysicsTickAngularBrake(InRigidBody, Thrusters, Wrench, DeltaTime);
+			OutOutput.bAngularBraking = true;
+		}
+
+		if (!Thrusters.Input.AngularThrustDirection.IsNearlyZero())
+		{
+			if (Thrusters.Input.bAlternativeTurning)
+			{
+				PhysicsTickScreenRelativeAngularThrust(InRigidBody, Thrusters, Wrench, DeltaTime);
+			}
+			else
+			{
+				PhysicsTickAngularThrust(InRigidBody, Thrusters, Wrench, DeltaTime);
+			}
+		}
+
+		OutOutput.LinearThrustVector = Thrusters.LinearThrustVector;
+		OutOutput.CurrentYawTorque = Thrusters.CurrentYawTorque;
+		OutOutput.bLinearThrustActive = Thrusters.bLinearThrustActive;
+		OutOutput.bAngularThrustActive = Thrusters.bAngularThrustActive;
+	}
+
+	AccumulateRocketThrust(InShip, InRigidBody.R(), FVector(InRigidBody.CenterOfMass()), DeltaTime, InOutCounters, Wrench);
+
+	if (!Wrench.Force.IsZero())
+	{
+		InRigidBody.AddForce(Wrench.Force, true);
+	}
+
+	if (!Wrench.Torque.IsZero())
+	{
+		InRigidBody.AddTorque(Wrench.Torque, true);
+	}
+
+	OutOutput.AppliedForce = Wrench.Force;
+	OutOutput.AppliedTorque = Wrench.Torque;
+}
+
+void FSGSM_PropulsionSimCallback::AccumulateRocketThrust(FSGSM_ShipState& InShip, const FQuat& InBodyRotation, const FVector& InCenterOfMass, float DeltaTime, FStepCounters& InOutCounters, FWrench& InOutWrench)
+{
+	for (const int32 RocketId : InShip.RocketIds)
+	{
+		FSGSM_RocketState& Rocket = Rockets[RocketIdToIndex[RocketId]];
+		if (Rocket.Input.bRocketThrusting)
+		{
+#if STATS
+			InOutCounters.FiringRockets.fetch_add(1, std::memory_order_relaxed);
+#endif
+			PhysicsTickRocketThrust(InBodyRotation, InCenterOfMass, Rocket, InOutWrench, DeltaTime);
+		}
+	}
+}
+
+void FSGSM_PropulsionSimCallback::ApplySimplifiedPropulsion(FSGSM_ShipState& InShip, Chaos::FRigidBodyHandle_Internal& InRigidBody, int32 InPhysicsFrame, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput)
+{
+#if STATS
+	InOutCounters.ActiveShips.fetch_add(1, std::memory_order_relaxed);
+	InOutCounters.MidShips.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	const int32 Interval = FMath::Max(GSGSM_LODMidStepInterval, 1);
+
+	if (InShip.bHasThrusters && InPhysicsFrame >= InShip.NextControllerFrame)
+	{
+		FSGSM_KinematicBody Body;
+		Body.Rotation = InRigidBody.R();
+		Body.LinearVelocity = InRigidBody.GetV();
+		Body.AngularVelocity = InRigidBody.GetW();
+		Body.Mass = InRigidBody.M();
+		Body.Inertia = static_cast<FVector>(InRigidBody.I()).GetMax();
+
+		FWrench ThrusterWrench;
+		SimplifiedTickThrusters(InShip.Thrusters, Body, DeltaTime * Interval, ThrusterWrench);
+
+		InShip.CachedForce = ThrusterWrench.Force;
+		InShip.CachedTorque = ThrusterWrench.Torque;
+		InShip.NextControllerFrame = InPhysicsFrame + Interval;
+	}
+
+	FWrench Wrench;
+	Wrench.Force = InShip.CachedForce;
+	Wrench.Torque = InShip.CachedTorque;
+
+	// Rockets are cheap and drive visuals, they keep running every step.
+	AccumulateRocketThrust(InShip, InRigidBody.R(), FVector(InRigidBody.CenterOfMass()), DeltaTime, InOutCounters, Wrench);
+
+	if (!Wrench.Force.IsZero())
+	{
+		InRigidBody.AddForce(Wrench.Force, true);
+	}
+
+	if (!Wrench.Torque.IsZero())
+	{
+		InRigidBody.AddTorque(Wrench.Torque, true);
+	}
+
+	OutOutput.AppliedForce = Wrench.Force;
+	OutOutput.AppliedTorque = Wrench.Torque;
+	OutOutput.LinearThrustVector = InShip.Thrusters.LinearThrustVector;
+	OutOutput.CurrentYawTorque = InShip.Thrusters.CurrentYawTorque;
+	OutOutput.bLinearThrustActive = InShip.Thrusters.bLinearThrustActive;
+	OutOutput.bAngularThrustActive = InShip.Thrusters.bAngularThrustActive;
+	OutOutput.bLinearBraking = InShip.Thrusters.Input.bLinearBrake && !InShip.Thrusters.bLinearThrustActive;
+	OutOutput.bAngularBraking = InShip.Thrusters.Input.bAngularBrake && !InShip.Thrusters.bAngularThrustActive;
+}
+
+void FSGSM_PropulsionSimCallback::IntegrateKinematic(FSGSM_ShipState& InShip, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput)
+{
+#if STATS
+	InOutCounters.ActiveShips.fetch_add(1, std::memory_order_relaxed);
+	InOutCounters.FarShips.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	FSGSM_KinematicBody& Body = InShip.Kinematic;
+
+	FWrench Wrench;
+
+	if (InShip.bHasThrusters)
+	{
+		SimplifiedTickThrusters(InShip.Thrusters, Body, DeltaTime, Wrench);
+
+		OutOutput.LinearThrustVector = InShip.Thrusters.LinearThrustVector;
+		OutOutput.CurrentYawTorque = InShip.Thrusters.CurrentYawTorque;
+		OutOutput.bLinearThrustActive = InShip.Thrusters.bLinearThrustActive;
+		OutOutput.bAngularThrustActive = InShip.Thrusters.bAngularThrustActive;
+		OutOutput.bLinearBraking = InShip.Thrusters.Input.bLinearBrake && !InShip.Thrusters.bLinearThrustActive;
+		OutOutput.bAngularBraking = InShip.Thrusters.Input.bAngularBrake && !InShip.Thrusters.bAngularThrustActive;
+	}
+
+	AccumulateRocketThrust(InShip, Body.Rotation, Body.CenterOfMass, DeltaTime, InOutCounters, Wrench);
+
+	SGSM_KinematicPropulsion::Integrate(Body, Wrench.Force, Wrench.Torque, DeltaTime);
+
+	OutOutput.AppliedForce = Wrench.Force;
+	OutOutput.AppliedTorque = Wrench.Torque;
+	OutOutput.Kinematic = Body;
+	OutOutput.bKinematic = true;
+}
+
+void FSGSM_PropulsionSimCallback::SimplifiedTickThrusters(FSGSM_ThrusterState& InOutThrusters, const FSGSM_KinematicBody& InBody, double InHorizon, FWrench& InOutWrench)
+{
+	SGSM_KinematicPropulsion::FThrusterResult Result;
+	SGSM_KinematicPropulsion::TickThrusters(InOutThrusters.Specs, InOutThrusters.Input, InBody, InHorizon, Result);
+
+	InOutWrench.Force += Result.Force;
+	InOutWrench.Torque += Result.Torque;
+
+	InOutThrusters.LinearThrustVector = Result.LinearThrustVector;
+	InOutThrusters.CurrentYawTorque = Result.CurrentYawTorque;
+	InOutThrusters.bLinearThrustActive = Result.bLinearThrustActive;
+	InOutThrusters.bAngularThrustActive = Result.bAngularThrustActive;
+}
+
+void FSGSM_PropulsionSimCallback::PublishOutputs(FSGSM_ShipState& InShip, const FSGSM_ShipOutputSnapshot& InOutput)
+{
+	InShip.OutputBuffer->Publish(InOutput);
+
+	for (const int32 RocketId : InShip.RocketIds)
+	{
+		FSGSM_RocketState& Rocket = Rockets[RocketIdToIndex[RocketId]];
+
+		FSGSM_RocketOutputSnapshot RocketOutput;
+		RocketOutput.AppliedThrustVector = Rocket.AppliedThrustVector;
+		RocketOutput.Frame = InOutput.Frame;
+
+		Rocket.OutputBuffer->Publish(RocketOutput);
+	}
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickLinearThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickLinearThrust);
+
+	const FVector Input = InOutThrusters.Input.LinearThrustDirection;
+
+	const FVector AppliedThrust = GetCurrentThrustOutput(InOutThrusters, InRigidBody.R(), Input);
+
+	InOutWrench.Force += AppliedThrust;
+	InOutThrusters.bLinearThrustActive = true;
+	InOutThrusters.LinearThrustVector = AppliedThrust;
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickLinearBrake(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickLinearBrake);
+
+	const FVector LinearVelocity = InRigidBody.GetV();
+
+	if (LinearVelocity.IsNearlyZero())
+	{
+		// Only settle the last bit of drift, writing zero every step would keep Chaos from ever sleeping the body.
+		if (!LinearVelocity.IsZero())
+		{
+			InRigidBody.SetV(FVector::ZeroVector);
+		}
+		InOutThrusters.LinearThrustVector = FVector::ZeroVector;
+		return;
+	}
+
+	const double BoostScale = InOutThrusters.Input.bBoosting ? InOutThrusters.Input.BoostPercent : 0;
+
+	const FVector AppliedThrust = SGSM_PropulsionMath::ToVector(SGSM_PropulsionMath::GetLinearBrakeForce(
+		InOutThrusters.Specs.Envelope.GetMath(), SGSM_PropulsionMath::ToMath(InRigidBody.R()), SGSM_PropulsionMath::ToMath(LinearVelocity), BoostScale));
+
+	InOutWrench.Force += AppliedThrust;
+	InOutThrusters.LinearThrustVector = AppliedThrust;
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickAngularThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickAngularThrust);
+
+	const double InputX = InOutThrusters.Input.AngularThrustDirection.X;
+	const double MaxRotationRadPerSec = FMath::DegreesToRadians(InOutThrusters.Specs.MaxRotationDegPerSec);
+
+	const FVector RigidBodyInertia = static_cast<FVector>(InRigidBody.I());
+	const double Inertia = RigidBodyInertia.GetMax();
+
+	double Torque = 0.0;
+	if (!SGSM_PropulsionMath::GetClampedYawTorque(InputX, InOutThrusters.Specs.MaxAngularCentinewtons, MaxRotationRadPerSec, Inertia, InRigidBody.GetW().Z, DeltaTime, Torque))
+	{
+		return;
+	}
+
+	InOutWrench.Torque += FVector::UpVector * Torque;
+
+	InOutThrusters.bAngularThrustActive = true;
+	InOutThrusters.CurrentYawTorque = Torque;
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickAngularBrake(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickAngularBrake);
+
+	const FVector AngularVelocity = InRigidBody.GetW();
+
+	if (AngularVelocity.IsNearlyZero())
+	{
+		if (!AngularVelocity.IsZero())
+		{
+			InRigidBody.SetW(FVector::ZeroVector);
+		}
+		InOutThrusters.CurrentYawTorque = 0.0;
+		return;
+	}
+
+	const double MaxTorque = InOutThrusters.Specs.MaxAngularCentinewtons;
+	const FVector RigidBodyInertia = static_cast<FVector>(InRigidBody.I());
+	double Inertia = RigidBodyInertia.GetMax();
+
+	const double DesiredDeceleration = AngularVelocity.Z / DeltaTime;
+	const double DesiredTorque = FMath::Abs(Inertia * DesiredDeceleration);
+	const double TorqueToApply = FMath::Min(DesiredTorque, MaxTorque);
+
+	const FVector TorqueUse = FVector::UpVector * (FMath::Sign(-AngularVelocity.Z) * TorqueToApply);
+
+	InOutWrench.Torque += TorqueUse;
+	InOutThrusters.CurrentYawTorque = TorqueUse.Z;
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickScreenRelativeAngularThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickScreenRelativeAngularThrust);
+
+	using namespace SGSM_PropulsionMath;
+
+	const FVector ForwardVector = InRigidBody.R().Vector();
+	const FVector DirectionVector = FVector(-InOutThrusters.Input.AngularThrustDirection.Y, InOutThrusters.Input.AngularThrustDirection.X, 0);
+
+	const FVector RigidBodyInertia = static_cast<FVector>(InRigidBody.I());
+	const double Inertia = RigidBodyInertia.GetMax();
+
+	const FSteeringCommand Command = GetScreenRelativeSteering(ToMath(ForwardVector), ToMath(DirectionVector), InRigidBody.W().Z,
+		InOutThrusters.Specs.MaxAngularCentinewtons, Inertia, FMath::DegreesToRadians(InOutThrusters.Specs.MissTolerance), DeltaTime);
+
+	if (Command.bStopRotation)
+	{
+		InRigidBody.SetW(FVector::ZeroVector, true);
+		InOutThrusters.CurrentYawTorque = 0;
+		return;
+	}
+
+	if (!Command.bApplyTorque)
+	{
+		return;
+	}
+
+	InOutWrench.Torque += FVector::UpVector * Command.Torque;
+	InOutThrusters.CurrentYawTorque = Command.Torque;
+
+	if (Command.bTurning)
+	{
+		InOutThrusters.bAngularThrustActive = true;
+	}
+}
+
+void FSGSM_PropulsionSimCallback::PhysicsTickRocketThrust(const FQuat& InBodyRotation, const FVector& InCenterOfMass, FSGSM_RocketState& InOutRocket, FWrench& InOutWrench, float DeltaTime)
+{
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PhysicsTickRocketThrust);
+
+	const FVector AppliedThrust = InOutRocket.Input.CurrentThrustVector;
+
+	if (AppliedThrust.IsNearlyZero())
+	{
+		return;
+	}
+
+	InOutWrench.Force += AppliedThrust;
+	InOutRocket.AppliedThrustVector = AppliedThrust;
+
+	if (SGSM_KinematicPropulsion::IsRocketMountTorqueEnabled())
+	{
+		const FVector LeverArm = InBodyRotation.RotateVector(InOutRocket.Input.MountOffset - InCenterOfMass);
+		InOutWrench.Torque += FVector::CrossProduct(LeverArm, AppliedThrust);
+	}
+}
+
+FVector FSGSM_PropulsionSimCallback::GetCurrentThrustOutput(const FSGSM_ThrusterState& InThrusters, const FQuat& InBodyRotation, const FVector& InDirection)
+{
+	return SGSM_KinematicPropulsion::GetThrustOutput(InThrusters.Specs, InThrusters.Input, InBodyRotation, InDirection);
+}
+
+double FSGSM_PropulsionSimCallback::GetMaxThrustMagnitude(const FSGSM_ThrusterState& InThrusters, const FQuat& InBodyRotation, const FVector& InDirection)
+{
+	return SGSM_KinematicPropulsion::GetMaxThrustMagnitude(InThrusters.Specs, InThrusters.Input, InBodyRotation, InDirection);
+}
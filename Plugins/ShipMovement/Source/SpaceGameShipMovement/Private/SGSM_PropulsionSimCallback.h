@@ -0,0 +1,165 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackObject.h"
+#include "SGSM_PropulsionState.h"
+#include <atomic>
+
+/*
+ * Single Chaos sim-callback that steps the propulsion of every registered ship.
+ * Ship and rocket states are kept in contiguous arrays and stepped in one pass, in parallel once the ship count passes a threshold.
+ * Registration happens on the game thread, stepping on the physics thread; both are guarded by RegistryLock.
+ */
+class FSGSM_PropulsionSimCallback : public Chaos::TSimCallbackObject<>
+{
+public:
+
+	FSGSM_ShipHandle AddShipReference(UPrimitiveComponent* InBody, bool bInHasThrusters);
+
+	/** Returns the body of the ship when this was its last reference and the ship was removed. */
+	UPrimitiveComponent* RemoveShipReference(FSGSM_ShipHandle InShipHandle, bool bInHasThrusters);
+
+	FSGSM_RocketHandle AddRocket(UPrimitiveComponent* InBody);
+	UPrimitiveComponent* RemoveRocket(FSGSM_RocketHandle InRocketHandle);
+
+	/** Re-captures the physics proxy of InBody after its physics state was created or destroyed. */
+	void RebindShip(const UPrimitiveComponent* InBody);
+
+	/** Replaces the thruster specifications of a ship, taking the registry lock so it never lands mid-step. */
+	void SetThrusterSpecs(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterSpecs& InSpecs);
+
+	/** Stamps and queues input for the physics step, without locking. */
+	void PushThrusterInput(FSGSM_ShipHandle InShipHandle, FSGSM_ThrusterInputSnapshot InSnapshot);
+	void PushRocketInput(FSGSM_RocketHandle InRocketHandle, FSGSM_RocketInputSnapshot InSnapshot);
+
+	/** Retries input that did not fit in a full channel. */
+	void FlushPendingInputs();
+
+	/** Game thread. Most recent complete output of a ship or rocket, nullptr when the handle is not registered. */
+	const FSGSM_ShipOutputSnapshot* ReadShipOutput(FSGSM_ShipHandle InShipHandle);
+	const FSGSM_RocketOutputSnapshot* ReadRocketOutput(FSGSM_RocketHandle InRocketHandle);
+
+	/*
+	 * Game thread. Moves ships between simulation tiers by their distance to the nearest viewpoint.
+	 * Bodies entering the far tier stop simulating and bodies leaving it resume with the velocities they were integrated to.
+	 * Bodies of actors replicating movement in a networked game stay simulating and stop at the mid tier.
+	 */
+	void UpdateLOD(TConstArrayView<FVector> InViewpoints);
+
+	/** Game thread. Moves the kinematic bodies of far ships to their latest integrated transform. */
+	void ApplyKinematicOutputs();
+
+	ESGSM_PropulsionLOD GetShipLOD(FSGSM_ShipHandle InShipHandle);
+
+	FSGSM_ShipState* GetShipState(FSGSM_ShipHandle InShipHandle);
+	FSGSM_RocketState* GetRocketState(FSGSM_RocketHandle InRocketHandle);
+
+	/** When enabled the duration of every propulsion step is recorded until drained, for benchmarks. */
+	void SetCaptureStepTimings(bool bInCapture);
+	void DrainStepTimings(TArray<double>& OutSeconds);
+
+	int32 GetNumShips() const { return Ships.Num(); }
+	int32 GetNumRockets() const { return Rockets.Num(); }
+
+protected:
+
+	virtual void OnPreSimulate_Internal() override;
+
+private:
+
+	/** Per-step counters, only gathered when stats are enabled. */
+	struct FStepCounters
+	{
+		std::atomic<int32> ActiveShips = 0;
+		std::atomic<int32> MidShips = 0;
+		std::atomic<int32> FarShips = 0;
+		std::atomic<int32> DormantShips = 0;
+		std::atomic<int32> BrakingShips = 0;
+		std::atomic<int32> FiringRockets = 0;
+		std::atomic<int32> MaxInputLatencyFrames = 0;
+	};
+
+	/** Net force and torque accumulated for one body during one step. */
+	struct FWrench
+	{
+		FVector Force = FVector::ZeroVector;
+		FVector Torque = FVector::ZeroVector;
+	};
+
+	void StepShip(FSGSM_ShipState& InShip, int32 InPhysicsFrame, float DeltaTime, FStepCounters& InOutCounters);
+
+	void ConsumeInputs(FSGSM_ShipState& InShip, int32 InPhysicsFrame, FStepCounters& InOutCounters);
+	void ApplyPropulsion(FSGSM_ShipState& InShip, Chaos::FRigidBodyHandle_Internal& InRigidBody, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput);
+	void PublishOutputs(FSGSM_ShipState& InShip, const FSGSM_ShipOutputSnapshot& InOutput);
+
+	/** Whether the ship has thruster or rocket input that needs the step. */
+	bool HasActiveInput(const FSGSM_ShipState& InShip) const;
+
+	/** A dormant ship wakes on active input, or when something outside propulsion got its body moving again. */
+	bool ShouldWake(const FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody) const;
+
+	/** Counts the steps a ship without input spent at rest and puts it to sleep once it has settled. */
+	void UpdateDormancy(FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody, FSGSM_ShipOutputSnapshot& InOutOutput) const;
+
+	static bool IsAtRest(const FSGSM_ShipState& InShip, const Chaos::FRigidBodyHandle_Internal* InRigidBody);
+
+	/** Mid tier, runs the simplified controller every few steps and re-applies its wrench in between. */
+	void ApplySimplifiedPropulsion(FSGSM_ShipState& InShip, Chaos::FRigidBodyHandle_Internal& InRigidBody, int32 InPhysicsFrame, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput);
+
+	/** Far tier, integrates the kinematic body with the simplified controller. */
+	void IntegrateKinematic(FSGSM_ShipState& InShip, float DeltaTime, FStepCounters& InOutCounters, FSGSM_ShipOutputSnapshot& OutOutput);
+
+	void AccumulateRocketThrust(FSGSM_ShipState& InShip, const FQuat& InBodyRotation, const FVector& InCenterOfMass, float DeltaTime, FStepCounters& InOutCounters, FWrench& InOutWrench);
+
+	/** Game thread. */
+	ESGSM_PropulsionLOD PickLOD(const FSGSM_ShipState& InShip, TConstArrayView<FVector> InViewpoints) const;
+	void SetShipLOD(FSGSM_ShipState& InShip, ESGSM_PropulsionLOD InLOD);
+
+	// Physics
+	static void PhysicsTickLinearThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime);
+	static void PhysicsTickLinearBrake(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime);
+
+	static void PhysicsTickAngularThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime);
+	static void PhysicsTickAngularBrake(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime);
+
+	static void PhysicsTickScreenRelativeAngularThrust(Chaos::FRigidBodyHandle_Internal& InRigidBody, FSGSM_ThrusterState& InOutThrusters, FWrench& InOutWrench, float DeltaTime);
+
+	static void PhysicsTickRocketThrust(const FQuat& InBodyRotation, const FVector& InCenterOfMass, FSGSM_RocketState& InOutRocket, FWrench& InOutWrench, float DeltaTime);
+
+	/*
+	 * Cheaper thruster model shared by the mid and far tiers.
+	 * Uses the same thrust envelope and turn limits, but steers straight for a target yaw rate and brakes to rest over InHorizon seconds.
+	 */
+	static void SimplifiedTickThrusters(FSGSM_ThrusterState& InOutThrusters, const FSGSM_KinematicBody& InBody, double InHorizon, FWrench& InOutWrench);
+
+	static FVector GetCurrentThrustOutput(const FSGSM_ThrusterState& InThrusters, const FQuat& InBodyRotation, const FVector& InDirection);
+	static double GetMaxThrustMagnitude(const FSGSM_ThrusterState& InThrusters, const FQuat& InBodyRotation, const FVector& InDirection);
+
+	FSGSM_ShipHandle FindShip(const UPrimitiveComponent* InBody) const;
+
+	static int32 AllocateId(TArray<int32>& InOutIdToIndex, TArray<int32>& InOutFreeIds, int32 InIndex);
+
+	template <typename SnapshotType>
+	void StampInput(SnapshotType& InOutSnapshot) const;
+
+private:
+
+	FCriticalSection RegistryLock;
+
+	/** Number of propulsion steps run so far, written by the physics thread only. */
+	std::atomic<int32> PhysicsFrame = 0;
+
+	std::atomic<bool> bCaptureStepTimings = false;
+	TArray<double> StepTimings;
+
+	TArray<FSGSM_ShipState> Ships;
+	TArray<int32> ShipIdToIndex;
+	TArray<int32> FreeShipIds;
+
+	TArray<FSGSM_RocketState> Rockets;
+	TArray<int32> RocketIdToIndex;
+	TArray<int32> FreeRocketIds;
+
+};
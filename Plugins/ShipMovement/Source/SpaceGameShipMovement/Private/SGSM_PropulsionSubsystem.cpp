@@ -0,0 +1,450 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PropulsionSubsystem.h"
+#include "SGSM_PropulsionSimCallback.h"
+#include "SGSM_PropulsionBrain.h"
+#include "SGSM_RocketComponent.h"
+#include "SGSM_LogCategory.h"
+#include "SGSM_Stats.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+
+
+USGSM_PropulsionSubsystem* USGSM_PropulsionSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USGSM_PropulsionSubsystem>() : nullptr;
+}
+
+bool USGSM_PropulsionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USGSM_PropulsionSubsystem::Deinitialize()
+{
+	if (SimCallback)
+	{
+		if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+		{
+			PhysScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(SimCallback);
+		}
+		SimCallback = nullptr;
+	}
+
+	Assemblies.Reset();
+	ModuleAssemblies.Reset();
+
+	Super::Deinitialize();
+}
+
+void USGSM_PropulsionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (SimCallback)
+	{
+		SimCallback->FlushPendingInputs();
+		UpdateLOD();
+	}
+
+	UpdatePropulsionStatuses();
+}
+
+void USGSM_PropulsionSubsystem::RegisterStatusBroadcast(USGSM_PropulsionBrain* InBrain)
+{
+	if (InBrain)
+	{
+		StatusBrains.AddUnique(InBrain);
+	}
+}
+
+void USGSM_PropulsionSubsystem::UnregisterStatusBroadcast(USGSM_PropulsionBrain* InBrain)
+{
+	const int32 Index = StatusBrains.Find(InBrain);
+	if (Index != INDEX_NONE)
+	{
+		StatusBrains[Index].Reset();
+	}
+}
+
+void USGSM_PropulsionSubsystem::UpdatePropulsionStatuses()
+{
+	if (StatusBrains.IsEmpty())
+	{
+		return;
+	}
+
+	SGSM_SCOPE_CYCLE_COUNTER(STAT_SGSM_PropulsionStatus);
+
+	// Brains registered by a listener are appended and still updated this frame.
+	for (int32 Index = 0; Index < StatusBrains.Num(); ++Index)
+	{
+		if (USGSM_PropulsionBrain* const Brain = StatusBrains[Index].Get())
+		{
+			Brain->UpdatePropulsionStatus();
+		}
+	}
+
+	StatusBrains.RemoveAllSwap([](const TWeakObjectPtr<USGSM_PropulsionBrain>& Brain) { return !Brain.IsValid(); });
+}
+
+void USGSM_PropulsionSubsystem::GetPlayerViewpoints(const UWorld* InWorld, TArray<FVector, TInlineAllocator<4>>& OutViewpoints)
+{
+	OutViewpoints.Reset();
+
+	for (FConstPlayerControllerIterator Iterator = InWorld->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* const PlayerController = Iterator->Get();
+		if (!PlayerController)
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		OutViewpoints.Add(ViewLocation);
+	}
+}
+
+void USGSM_PropulsionSubsystem::UpdateLOD()
+{
+	TArray<FVector, TInlineAllocator<4>> Viewpoints;
+	GetPlayerViewpoints(GetWorld(), Viewpoints);
+
+	SimCallback->UpdateLOD(Viewpoints);
+	SimCallback->ApplyKinematicOutputs();
+}
+
+ESGSM_PropulsionLOD USGSM_PropulsionSubsystem::GetShipLOD(FSGSM_ShipHandle InShipHandle) const
+{
+	return SimCallback ? SimCallback->GetShipLOD(InShipHandle) : ESGSM_PropulsionLOD::Near;
+}
+
+TStatId USGSM_PropulsionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGSM_PropulsionSubsystem, STATGROUP_Tickables);
+}
+
+FSGSM_PropulsionSimCallback* USGSM_PropulsionSubsystem::GetOrCreateSimCallback()
+{
+	if (!SimCallback)
+	{
+		FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+		if (!ensureAlwaysMsgf(PhysScene, TEXT("Failed to get Physics Scene")))
+		{
+			return nullptr;
+		}
+
+		SimCallback = PhysScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FSGSM_PropulsionSimCallback>();
+		UE_LOG(SMLogPropulsion, Verbose, TEXT("Registered propulsion sim-callback for \"%s\""), *GetNameSafe(GetWorld()));
+	}
+	return SimCallback;
+}
+
+UPrimitiveComponent* USGSM_PropulsionSubsystem::GetSimulatedBody(UPrimitiveComponent* InBody)
+{
+	if (InBody && InBody->BodyInstance.WeldParent && InBody->BodyInstance.WeldParent->OwnerComponent.IsValid())
+	{
+		return InBody->BodyInstance.WeldParent->OwnerComponent.Get();
+	}
+	return InBody;
+}
+
+void USGSM_PropulsionSubsystem::BindBody(UPrimitiveComponent* InBody)
+{
+	if (InBody)
+	{
+		InBody->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &ThisClass::OnBodyPhysicsStateChanged);
+	}
+}
+
+void USGSM_PropulsionSubsystem::UnbindBody(UPrimitiveComponent* InBody)
+{
+	if (InBody)
+	{
+		InBody->OnComponentPhysicsStateChanged.RemoveDynamic(this, &ThisClass::OnBodyPhysicsStateChanged);
+	}
+}
+
+void USGSM_PropulsionSubsystem::OnBodyPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange)
+{
+	if (SimCallback)
+	{
+		SimCallback->RebindShip(ChangedComponent);
+	}
+}
+
+FSGSM_ShipHandle USGSM_PropulsionSubsystem::RegisterThrusters(UPrimitiveComponent* InBody)
+{
+	if (FSGSM_PropulsionSimCallback* Callback = GetOrCreateSimCallback())
+	{
+		UPrimitiveComponent* const Body = GetSimulatedBody(InBody);
+		BindBody(Body);
+		return Callback->AddShipReference(Body, true);
+	}
+	return FSGSM_ShipHandle{};
+}
+
+void USGSM_PropulsionSubsystem::UnregisterThrusters(FSGSM_ShipHandle& InOutShipHandle)
+{
+	if (SimCallback && InOutShipHandle.IsValid())
+	{
+		UnbindBody(SimCallback->RemoveShipReference(InOutShipHandle, true));
+	}
+	InOutShipHandle.Reset();
+}
+
+FSGSM_RocketHandle USGSM_PropulsionSubsystem::RegisterRocket(UPrimitiveComponent* InBody)
+{
+	if (FSGSM_PropulsionSimCallback* Callback = GetOrCreateSimCallback())
+	{
+		UPrimitiveComponent* const Body = GetSimulatedBody(InBody);
+		BindBody(Body);
+		return Callback->AddRocket(Body);
+	}
+	return FSGSM_RocketHandle{};
+}
+
+void USGSM_PropulsionSubsystem::UnregisterRocket(FSGSM_RocketHandle& InOutRocketHandle)
+{
+	if (SimCallback && InOutRocketHandle.IsValid())
+	{
+		UnbindBody(SimCallback->RemoveRocket(InOutRocketHandle));
+	}
+	InOutRocketHandle.Reset();
+}
+
+void USGSM_PropulsionSubsystem::SetThrusterSpecs(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterSpecs& InSpecs)
+{
+	if (SimCallback)
+	{
+		SimCallback->SetThrusterSpecs(InShipHandle, InSpecs);
+	}
+}
+
+void USGSM_PropulsionSubsystem::PushThrusterInput(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterInputSnapshot& InSnapshot)
+{
+	if (SimCallback)
+	{
+		SimCallback->PushThrusterInput(InShipHandle, InSnapshot);
+	}
+}
+
+void USGSM_PropulsionSubsystem::PushRocketInput(FSGSM_RocketHandle InRocketHandle, const FSGSM_RocketInputSnapshot& InSnapshot)
+{
+	if (SimCallback)
+	{
+		SimCallback->PushRocketInput(InRocketHandle, InSnapshot);
+	}
+}
+
+FSGSM_ShipOutputSnapshot USGSM_PropulsionSubsystem::ReadShipOutput(FSGSM_ShipHandle InShipHandle) const
+{
+	const FSGSM_ShipOutputSnapshot* Output = SimCallback ? SimCallback->ReadShipOutput(InShipHandle) : nullptr;
+	return Output ? *Output : FSGSM_ShipOutputSnapshot();
+}
+
+FSGSM_RocketOutputSnapshot USGSM_PropulsionSubsystem::ReadRocketOutput(FSGSM_RocketHandle InRocketHandle) const
+{
+	const FSGSM_RocketOutputSnapshot* Output = SimCallback ? SimCallback->ReadRocketOutput(InRocketHandle) : nullptr;
+	return Output ? *Output : FSGSM_RocketOutputSnapshot();
+}
+
+FSGSM_ShipAssembly* USGSM_PropulsionSubsystem::FindAssembly(const AActor* InRootActor) const
+{
+	const TUniquePtr<FSGSM_ShipAssembly>* Assembly = Assemblies.Find(InRootActor);
+	return Assembly ? Assembly->Get() : nullptr;
+}
+
+FSGSM_ShipAssembly& USGSM_PropulsionSubsystem::FindOrAddAssembly(AActor* InRootActor)
+{
+	TUniquePtr<FSGSM_ShipAssembly>& Assembly = Assemblies.FindOrAdd(InRootActor);
+	if (!Assembly)
+	{
+		Assembly = MakeUnique<FSGSM_ShipAssembly>();
+		Assembly->RootKey = InRootActor;
+		Assembly->RootActor = InRootActor;
+		Assembly->PhysicsRoot = GetSimulatedBody(Cast<UPrimitiveComponent>(InRootActor->GetRootComponent()));
+		Assembly->RootMesh = InRootActor->GetComponentByClass<UStaticMeshComponent>();
+
+		UE_LOG(SMLogPropulsion, Verbose, TEXT("Created ship assembly for \"%s\""), *GetNameSafe(InRootActor));
+	}
+	return *Assembly;
+}
+
+void USGSM_PropulsionSubsystem::RemoveAssemblyIfEmpty(FSGSM_ShipAssembly* InAssembly)
+{
+	if (InAssembly && InAssembly->IsEmpty())
+	{
+		Assemblies.Remove(InAssembly->RootKey);
+	}
+}
+
+FSGSM_ShipAssembly* USGSM_PropulsionSubsystem::JoinAssembly(USGSM_RocketComponent* InRocket)
+{
+	AActor* const Module = InRocket ? InRocket->GetOwner() : nullptr;
+	if (!Module)
+	{
+		return nullptr;
+	}
+
+	AActor* const RootActor = Module->GetAttachmentRootActor();
+
+	FSGSM_ShipAssembly& Assembly = FindOrAddAssembly(RootActor);
+	Assembly.ModuleRockets.FindOrAdd(Module).AddUnique(InRocket);
+	ModuleAssemblies.Add(Module, &Assembly);
+
+	if (USGSM_PropulsionBrain* const Brain = Assembly.Brain.Get())
+	{
+		Brain->OnAssemblyRocketJoined(InRocket);
+	}
+
+	return &Assembly;
+}
+
+void USGSM_PropulsionSubsystem::LeaveAssembly(USGSM_RocketComponent* InRocket, FSGSM_ShipAssembly* InAssembly)
+{
+	if (!InRocket || !InAssembly)
+	{
+		return;
+	}
+
+	const TObjectKey<AActor> Module(InRocket->GetOwner());
+	if (TArray<TWeakObjectPtr<USGSM_RocketComponent>>* ModuleRockets = InAssembly->ModuleRockets.Find(Module))
+	{
+		ModuleRockets->Remove(InRocket);
+		if (ModuleRockets->IsEmpty())
+		{
+			InAssembly->ModuleRockets.Remove(Module);
+			ModuleAssemblies.Remove(Module);
+		}
+	}
+
+	if (USGSM_PropulsionBrain* const Brain = InAssembly->Brain.Get())
+	{
+		Brain->OnAssemblyRocketLeft(InRocket);
+	}
+
+	RemoveAssemblyIfEmpty(InAssembly);
+}
+
+FSGSM_ShipAssembly* USGSM_PropulsionSubsystem::RegisterBrain(USGSM_PropulsionBrain* InBrain)
+{
+	AActor* const Owner = InBrain ? InBrain->GetOwner() : nullptr;
+	if (!Owner)
+	{
+		return nullptr;
+	}
+
+	FSGSM_ShipAssembly& Assembly = FindOrAddAssembly(Owner->GetAttachmentRootActor());
+	ensureAlwaysMsgf(!Assembly.Brain.IsValid() || Assembly.Brain == InBrain, TEXT("Ship \"%s\" already has a propulsion brain"), *GetNameSafe(Owner));
+	Assembly.Brain = InBrain;
+
+	Assembly.ForEachRocket([InBrain](USGSM_RocketComponent* Rocket)
+	{
+		InBrain->OnAssemblyRocketJoined(Rocket);
+	});
+
+	return &Assembly;
+}
+
+void USGSM_PropulsionSubsystem::UnregisterBrain(USGSM_PropulsionBrain* InBrain, FSGSM_ShipAssembly* InAssembly)
+{
+	if (InAssembly && InAssembly->Brain == InBrain)
+	{
+		InAssembly->Brain.Reset();
+		RemoveAssemblyIfEmpty(InAssembly);
+	}
+}
+
+void USGSM_PropulsionSubsystem::NotifyModuleAttachmentChanged(AActor* InModule)
+{
+	if (!InModule)
+	{
+		return;
+	}
+
+	// The module and anything attached below it may now report a different attachment root than their assembly,
+	// modules without rockets still carry the ones attached to them.
+	TArray<AActor*> Modules;
+	InModule->GetAttachedActors(Modules, true, true);
+	Modules.Add(InModule);
+
+	TArray<USGSM_RocketComponent*, TInlineAllocator<16>> MovedRockets;
+	for (AActor* const Module : Modules)
+	{
+		FSGSM_ShipAssembly* const* Assembly = ModuleAssemblies.Find(Module);
+		if (!Assembly || Module->GetAttachmentRootActor() == (*Assembly)->RootActor.Get())
+		{
+			continue;
+		}
+
+		if (const TArray<TWeakObjectPtr<USGSM_RocketComponent>>* const ModuleRockets = (*Assembly)->ModuleRockets.Find(Module))
+		{
+			for (const TWeakObjectPtr<USGSM_RocketComponent>& Rocket : *ModuleRockets)
+			{
+				if (USGSM_RocketComponent* const RocketComponent = Rocket.Get())
+				{
+					MovedRockets.Add(RocketComponent);
+				}
+			}
+		}
+	}
+
+	for (USGSM_RocketComponent* const Rocket : MovedRockets)
+	{
+		Rocket->RefreshAssembly();
+	}
+}
+
+bool USGSM_PropulsionSubsystem::AttachModule(AActor* InModule, USceneComponent* InParent, FName InSocketName)
+{
+	if (!InModule || !InParent)
+	{
+		return false;
+	}
+
+	const bool bAttached = InModule->AttachToComponent(InParent, FAttachmentTransformRules::KeepWorldTransform, InSocketName);
+	NotifyModuleAttachmentChanged(InModule);
+	return bAttached;
+}
+
+void USGSM_PropulsionSubsystem::DetachModule(AActor* InModule)
+{
+	if (InModule)
+	{
+		InModule->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		NotifyModuleAttachmentChanged(InModule);
+	}
+}
+
+void USGSM_PropulsionSubsystem::SetCaptureStepTimings(bool bInCapture)
+{
+	if (FSGSM_PropulsionSimCallback* const Callback = GetOrCreateSimCallback())
+	{
+		Callback->SetCaptureStepTimings(bInCapture);
+	}
+}
+
+void USGSM_PropulsionSubsystem::DrainStepTimings(TArray<double>& OutSeconds)
+{
+	if (SimCallback)
+	{
+		SimCallback->DrainStepTimings(OutSeconds);
+	}
+}
+
+int32 USGSM_PropulsionSubsystem::GetNumShips() const
+{
+	return SimCallback ? SimCallback->GetNumShips() : 0;
+}
+
+int32 USGSM_PropulsionSubsystem::GetNumRockets() const
+{
+	return SimCallback ? SimCallback->GetNumRockets() : 0;
+}
@@ -1,15 +1,15 @@
 // Copyright Distant Light Games, Inc. All Rights Reserved.
 
 #include "SGSM_RocketComponent.h"
-#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "SGSM_PropulsionSubsystem.h"
+#include "SGSM_ShipAssembly.h"
 
 
 USGSM_RocketComponent::USGSM_RocketComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.TickGroup = TG_DuringPhysics;
-	SetAsyncPhysicsTickEnabled(true);
+	// Thrust is pushed from TickThrust calls and read back from the propulsion step output.
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 void USGSM_RocketComponent::BeginPlay()
@@ -20,73 +20,119 @@ void USGSM_RocketComponent::BeginPlay()
 	{
 		PrimitiveComponent = Cast<UPrimitiveComponent>(Owner->GetRootComponent());
 		ensureAlwaysMsgf(PrimitiveComponent, TEXT("Failed to get Owner Root Component as Primitive Component"));
+	}
 
-		OwnerRootMesh = GetRootMesh();
-		ensureAlwaysMsgf(OwnerRootMesh, TEXT("Failed to get Owner Root Static Mesh Component"));
+	PropulsionSubsystem = USGSM_PropulsionSubsystem::Get(this);
+	if (PropulsionSubsystem)
+	{
+		Assembly = PropulsionSubsystem->JoinAssembly(this);
 	}
+
+	OwnerRootMesh = GetRootMesh();
+	ensureAlwaysMsgf(OwnerRootMesh, TEXT("Failed to get Owner Root Static Mesh Component"));
+
+	RegisterRocket();
 }
 
-void USGSM_RocketComponent::AsyncPhysicsTickComponent(float DeltaTime, float SimTime)
+void USGSM_RocketComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::AsyncPhysicsTickComponent(DeltaTime, SimTime);
+	UnregisterRocket();
 
-	if (PrimitiveComponent && !PrimitiveComponent->IsSimulatingPhysics())
+	if (PropulsionSubsystem)
 	{
-		return;
+		PropulsionSubsystem->LeaveAssembly(this, Assembly);
+		Assembly = nullptr;
 	}
+	PropulsionSubsystem = nullptr;
 
-	if (RocketInput.bRocketThrusting)
-	{
-		PhysicsTickThrust(DeltaTime);
-	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void USGSM_RocketComponent::OnAttachmentChanged()
 {
 	Super::OnAttachmentChanged();
 
-	OwnerRootMesh = GetRootMesh();
+	if (HasBegunPlay())
+	{
+		RefreshAssembly();
+	}
 }
 
-void USGSM_RocketComponent::PhysicsTickThrust(float DeltaTime) const
+void USGSM_RocketComponent::RefreshAssembly()
 {
-	Chaos::FRigidBodyHandle_Internal* RigidBodyHandle = SGSM_Utils::GetRigidBodyHandle(PrimitiveComponent);
-	if (!RigidBodyHandle)
+	if (PropulsionSubsystem)
 	{
-		return;
+		PropulsionSubsystem->LeaveAssembly(this, Assembly);
+		Assembly = PropulsionSubsystem->JoinAssembly(this);
 	}
 
-	const FVector AppliedThrust = CurrentThrustVector;
+	OwnerRootMesh = GetRootMesh();
 
-	if (AppliedThrust.IsNearlyZero())
+	if (PropulsionSubsystem)
 	{
-		return;
+		RegisterRocket();
 	}
 
-	RigidBodyHandle->AddForce(AppliedThrust, true);
+	OnRocketAttachmentChanged.Broadcast(this);
 }
 
-UStaticMeshComponent* USGSM_RocketComponent::GetRootMesh() const
+void USGSM_RocketComponent::RegisterRocket()
 {
-	UStaticMeshComponent* RootMesh = nullptr;
-	if (const AActor* Owner = GetOwner())
+	UnregisterRocket();
+
+	if (PropulsionSubsystem && PrimitiveComponent)
 	{
-		RootMesh = Owner->GetComponentByClass<UStaticMeshComponent>();
+		RocketHandle = PropulsionSubsystem->RegisterRocket(PrimitiveComponent);
+		PushThrust();
+	}
+}
 
-		const UPrimitiveComponent* RootComponent = Cast<UPrimitiveComponent>(Owner->GetRootComponent());
+void USGSM_RocketComponent::UnregisterRocket()
+{
+	if (PropulsionSubsystem)
+	{
+		PropulsionSubsystem->UnregisterRocket(RocketHandle);
+	}
+}
+
+void USGSM_RocketComponent::PushThrust() const
+{
+	if (PropulsionSubsystem)
+	{
+		FSGSM_RocketInputSnapshot Snapshot;
+		Snapshot.CurrentThrustVector = CurrentThrustVector;
+		Snapshot.MountOffset = GetMountOffset();
+		Snapshot.bRocketThrusting = RocketInput.bRocketThrusting;
+
+		PropulsionSubsystem->PushRocketInput(RocketHandle, Snapshot);
+	}
+}
+
+FVector USGSM_RocketComponent::GetMountOffset() const
+{
+	if (!PrimitiveComponent)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Welded components share the body instance of their weld parent, which is the body the force lands on.
+	const FBodyInstance* BodyInstance = PrimitiveComponent->GetBodyInstance();
+	const UPrimitiveComponent* Body = BodyInstance && BodyInstance->OwnerComponent.IsValid() ? BodyInstance->OwnerComponent.Get() : PrimitiveComponent;
+
+	return Body->GetComponentTransform().InverseTransformPositionNoScale(GetComponentLocation());
+}
 
-		if (RootComponent && RootComponent->GetAttachmentRootActor())
-		{
-			if (const AActor* RootOwner = RootComponent->GetAttachmentRootActor()->GetOwner())
-			{
-				if (UStaticMeshComponent* StaticMesh = RootOwner->GetComponentByClass<UStaticMeshComponent>())
-				{
-					RootMesh = StaticMesh;
-				}
-			}
-		}
+UStaticMeshComponent* USGSM_RocketComponent::GetRootMesh() const
+{
+	if (Assembly)
+	{
+		return Assembly->RootMesh.Get();
 	}
-	return RootMesh;
+
+	// Outside of game worlds there is no assembly graph, fall back to the mesh of the attachment root.
+	const AActor* const Owner = GetOwner();
+	const AActor* const RootActor = Owner ? Owner->GetAttachmentRootActor() : nullptr;
+	return RootActor ? RootActor->GetComponentByClass<UStaticMeshComponent>() : nullptr;
 }
 
 void USGSM_RocketComponent::TickThrust(const double InScale)
@@ -95,6 +141,17 @@ void USGSM_RocketComponent::TickThrust(const double InScale)
 	{
 		CurrentThrustVector = GetMaxThrustVector() * InScale;
 		RocketInput.bRocketThrusting = true;
+		PushThrust();
+	}
+}
+
+void USGSM_RocketComponent::TickThrustVector(const FVector& InThrustVector)
+{
+	if (OwnerRootMesh)
+	{
+		CurrentThrustVector = InThrustVector;
+		RocketInput.bRocketThrusting = true;
+		PushThrust();
 	}
 }
 
@@ -102,6 +159,7 @@ void USGSM_RocketComponent::EndThrust()
 {
 	CurrentThrustVector = FVector::ZeroVector;
 	RocketInput.bRocketThrusting = false;
+	PushThrust();
 }
 
 FVector USGSM_RocketComponent::GetMaxThrustVector() const
@@ -116,31 +174,74 @@ bool USGSM_RocketComponent::IsRocketThrusting() const
 
 double USGSM_RocketComponent::GetCurrentThrustPower() const
 {
-	return CurrentThrustVector.Length();
+	return GetCurrentThrustVector().Length();
 }
 
 FVector USGSM_RocketComponent::GetCurrentThrustVector() const
 {
-	return CurrentThrustVector;
+	// Thrust actually applied by the latest physics step, not the requested one.
+	return PropulsionSubsystem ? PropulsionSubsystem->ReadRocketOutput(RocketHandle).AppliedThrustVector : FVector::ZeroVector;
 }
 
 double USGSM_RocketComponent::GetMaxThrustPower() const
 {
 	if (!ensure(RocketInterface)) return 0.0;
-	const auto Multiplier = ISGSM_Rocket::Execute_GetCurrentEfficiencyMultiplier(RocketInterface.GetObject());
+	const double Multiplier = GetEfficiencyMultiplier();
 	return SGSM_Utils::GetKiloNewtonToCentiNewtons(MaxLinearKiloNewtons * Multiplier);
 }
 
+double USGSM_RocketComponent::GetEfficiencyMultiplier() const
+{
+	if (const ISGSM_Rocket* const NativeRocket = RocketInterface.GetInterface())
+	{
+		return NativeRocket->GetCurrentEfficiencyMultiplierPure();
+	}
+
+	if (EfficiencySampleFrame == MAX_uint64 || (bSampleEfficiencyEveryFrame && EfficiencySampleFrame != GFrameCounter))
+	{
+		CachedEfficiencyMultiplier = SampleEfficiencyMultiplier();
+		EfficiencySampleFrame = GFrameCounter;
+	}
+	return CachedEfficiencyMultiplier;
+}
+
+double USGSM_RocketComponent::SampleEfficiencyMultiplier() const
+{
+	UObject* const RocketObject = RocketInterface.GetObject();
+	return RocketObject ? ISGSM_Rocket::Execute_GetCurrentEfficiencyMultiplier(RocketObject) : 0.0;
+}
+
+void USGSM_RocketComponent::NotifyEfficiencyChanged()
+{
+	const ISGSM_Rocket* const NativeRocket = RocketInterface.GetInterface();
+	CachedEfficiencyMultiplier = NativeRocket ? NativeRocket->GetCurrentEfficiencyMultiplierPure() : SampleEfficiencyMultiplier();
+	EfficiencySampleFrame = GFrameCounter;
+
+	if (!FMath::IsNearlyEqual(NotifiedEfficiencyMultiplier, CachedEfficiencyMultiplier))
+	{
+		NotifiedEfficiencyMultiplier = CachedEfficiencyMultiplier;
+		OnRocketEfficiencyChanged.Broadcast(this);
+	}
+}
+
 void USGSM_RocketComponent::SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications)
 {
-	RocketInput.BoostMultiplier = InRocketSpecifications.BoostMultiplier;
+	SetMaxLinearThrust(InRocketSpecifications.LinearThrustKiloNewtons, FSGSM_DirectionMultipliers::Compile(InRocketSpecifications.BoostMultiplier));
+}
+
+void USGSM_RocketComponent::SetShipClassData(const FSGSM_ShipClassData& InShipClassData)
+{
+	SetMaxLinearThrust(InShipClassData.RocketLinearThrustKiloNewtons, InShipClassData.RocketBoostMultiplier);
+}
 
+void USGSM_RocketComponent::SetMaxLinearThrust(double InLinearThrustKiloNewtons, const FSGSM_DirectionMultipliers& InBoostMultiplier)
+{
 	const FVector ForwardVector = GetForwardVector();
 
 	if (OwnerRootMesh)
 	{
-		const FVector ThrustMultiplier = SGSM_Utils::GetThrustEngagementVector(OwnerRootMesh->GetForwardVector(), ForwardVector, RocketInput.BoostMultiplier);
+		const FVector ThrustMultiplier = SGSM_Utils::GetThrustEngagementVector(OwnerRootMesh->GetForwardVector(), ForwardVector, InBoostMultiplier);
 
-		MaxLinearKiloNewtons = InRocketSpecifications.LinearThrustKiloNewtons * ThrustMultiplier.Length();
+		MaxLinearKiloNewtons = InLinearThrustKiloNewtons * ThrustMultiplier.Length();
 	}
 }
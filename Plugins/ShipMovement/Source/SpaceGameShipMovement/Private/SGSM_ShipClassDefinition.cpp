@@ -0,0 +1,112 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_ShipClassDefinition.h"
+
+
+const FSGSM_ShipClassData FSGSM_ShipClassData::Empty;
+
+TSharedRef<const FSGSM_ShipClassData> FSGSM_ShipClassData::Make(const FThrustersSpecifications& InThrusterSpecifications, const FRocketSpecifications& InRocketSpecifications)
+{
+	TSharedRef<FSGSM_ShipClassData> ClassData = MakeShared<FSGSM_ShipClassData>();
+	ClassData->SetThrusterSpecifications(InThrusterSpecifications);
+	ClassData->SetRocketSpecifications(InRocketSpecifications);
+	return ClassData;
+}
+
+void FSGSM_ShipClassData::SetThrusterSpecifications(const FThrustersSpecifications& InThrusterSpecifications)
+{
+	MaxLinearKiloNewtons = InThrusterSpecifications.LinearThrustKiloNewtons;
+	MaxYawKiloNewtons = InThrusterSpecifications.TorqueKiloNewtons;
+	MaxRotationDegPerSec = InThrusterSpecifications.MaxAngularVelocity;
+
+	ThrustMultiplier = FSGSM_DirectionMultipliers::Compile(InThrusterSpecifications.ThrustMultiplier);
+	BoostMultiplier = FSGSM_DirectionMultipliers::Compile(InThrusterSpecifications.BoostMultiplier);
+
+	RebuildThrustEnvelope();
+}
+
+void FSGSM_ShipClassData::SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications)
+{
+	RocketLinearThrustKiloNewtons = InRocketSpecifications.LinearThrustKiloNewtons;
+	RocketBoostMultiplier = FSGSM_DirectionMultipliers::Compile(InRocketSpecifications.BoostMultiplier);
+}
+
+void FSGSM_ShipClassData::RebuildThrustEnvelope()
+{
+	ThrustEnvelope = FSGSM_ThrustEnvelope::Build(SGSM_Utils::GetKiloNewtonToCentiNewtons(MaxLinearKiloNewtons), ThrustMultiplier, BoostMultiplier);
+}
+
+bool FSGSM_ShipClassOverrides::HasAnyOverride() const
+{
+	return bOverride_LinearThrustKiloNewtons || bOverride_TorqueKiloNewtons || bOverride_MaxAngularVelocity || bOverride_RocketLinearThrustKiloNewtons;
+}
+
+TSharedRef<const FSGSM_ShipClassData> FSGSM_ShipClassOverrides::Apply(const TSharedRef<const FSGSM_ShipClassData>& InClassData) const
+{
+	if (!HasAnyOverride())
+	{
+		return InClassData;
+	}
+
+	TSharedRef<FSGSM_ShipClassData> ClassData = MakeShared<FSGSM_ShipClassData>(*InClassData);
+
+	if (bOverride_LinearThrustKiloNewtons)
+	{
+		ClassData->MaxLinearKiloNewtons = LinearThrustKiloNewtons;
+		ClassData->RebuildThrustEnvelope();
+	}
+	if (bOverride_TorqueKiloNewtons)
+	{
+		ClassData->MaxYawKiloNewtons = TorqueKiloNewtons;
+	}
+	if (bOverride_MaxAngularVelocity)
+	{
+		ClassData->MaxRotationDegPerSec = MaxAngularVelocity;
+	}
+	if (bOverride_RocketLinearThrustKiloNewtons)
+	{
+		ClassData->RocketLinearThrustKiloNewtons = RocketLinearThrustKiloNewtons;
+	}
+
+	return ClassData;
+}
+
+const FPrimaryAssetType USGSM_ShipClassDefinition::PrimaryAssetType = TEXT("SGSM_ShipClass");
+
+FPrimaryAssetId USGSM_ShipClassDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+void USGSM_ShipClassDefinition::PostLoad()
+{
+	Super::PostLoad();
+
+	// Baked once per class as it loads, spawning a ship only copies the pointer.
+	Bake();
+}
+
+#if WITH_EDITOR
+void USGSM_ShipClassDefinition::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Ships already holding the previous data keep it until they are handed the class again.
+	Bake();
+}
+#endif
+
+TSharedRef<const FSGSM_ShipClassData> USGSM_ShipClassDefinition::GetClassData() const
+{
+	if (!ClassData.IsValid())
+	{
+		Bake();
+	}
+
+	return ClassData.ToSharedRef();
+}
+
+void USGSM_ShipClassDefinition::Bake() const
+{
+	ClassData = FSGSM_ShipClassData::Make(ThrusterSpecs, RocketSpecs);
+}
@@ -0,0 +1,532 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_ShipStateSnapshot.h"
+#include "SGSM_LogCategory.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "Math/RandomStream.h"
+
+
+namespace SGSM_ShipStateSnapshot
+{
+	enum EChangedFields : uint8
+	{
+		Location = 1 << 0,
+		Velocity = 1 << 1,
+		Yaw = 1 << 2,
+		YawRate = 1 << 3,
+		Thrust = 1 << 4,
+		Rockets = 1 << 5,
+		HasBaseline = 1 << 6,
+		NumFieldBits = 7
+	};
+
+	static int32 QuantizeFixed(double InValue, double InResolution)
+	{
+		return static_cast<int32>(FMath::Clamp<int64>(FMath::RoundToInt64(InValue / InResolution), MIN_int32, MAX_int32));
+	}
+
+	static int8 QuantizeSigned(double InValue)
+	{
+		return static_cast<int8>(FMath::RoundToInt(FMath::Clamp(InValue, -1.0, 1.0) * 127.0));
+	}
+
+	static uint8 QuantizeUnsigned(double InValue)
+	{
+		return static_cast<uint8>(FMath::RoundToInt(FMath::Clamp(InValue, 0.0, 1.0) * 255.0));
+	}
+
+	static void SerializeDelta(FArchive& Ar, int32& InOutValue, int32 InBaseline)
+	{
+		// Zigzag so small negative deltas stay small as varints.
+		const int32 Delta = InOutValue - InBaseline;
+		uint32 Encoded = (static_cast<uint32>(Delta) << 1) ^ static_cast<uint32>(Delta >> 31);
+		Ar.SerializeIntPacked(Encoded);
+
+		if (Ar.IsLoading())
+		{
+			const int32 Decoded = static_cast<int32>(Encoded >> 1) ^ -static_cast<int32>(Encoded & 1);
+			InOutValue = InBaseline + Decoded;
+		}
+	}
+
+	static void SerializeDelta(FArchive& Ar, FIntVector& InOutValue, const FIntVector& InBaseline)
+	{
+		SerializeDelta(Ar, InOutValue.X, InBaseline.X);
+		SerializeDelta(Ar, InOutValue.Y, InBaseline.Y);
+		SerializeDelta(Ar, InOutValue.Z, InBaseline.Z);
+	}
+
+	static bool HasSameThrust(const FSGSM_QuantizedShipState& A, const FSGSM_QuantizedShipState& B)
+	{
+		return A.LinearThrustX == B.LinearThrustX && A.LinearThrustY == B.LinearThrustY && A.YawTorque == B.YawTorque && A.AverageRocketPower == B.AverageRocketPower;
+	}
+}
+
+FSGSM_QuantizedShipState FSGSM_QuantizedShipState::Quantize(const FSGSM_ShipStateSample& InSample)
+{
+	using namespace SGSM_ShipStateSnapshot;
+
+	FSGSM_QuantizedShipState Result;
+	Result.Location = FIntVector(QuantizeFixed(InSample.Location.X, LocationResolution), QuantizeFixed(InSample.Location.Y, LocationResolution), QuantizeFixed(InSample.Location.Z, LocationResolution));
+	Result.Velocity = FIntVector(QuantizeFixed(InSample.LinearVelocity.X, VelocityResolution), QuantizeFixed(InSample.LinearVelocity.Y, VelocityResolution), QuantizeFixed(InSample.LinearVelocity.Z, VelocityResolution));
+	Result.Yaw = FRotator::CompressAxisToShort(InSample.Yaw);
+	Result.YawRate = static_cast<int16>(FMath::Clamp(FMath::RoundToInt(InSample.YawRate / YawRateResolution), MIN_int16, MAX_int16));
+
+	Result.LinearThrustX = QuantizeSigned(InSample.LinearThrustNormal.X);
+	Result.LinearThrustY = QuantizeSigned(InSample.LinearThrustNormal.Y);
+	Result.YawTorque = QuantizeSigned(InSample.YawTorqueNormalized);
+	Result.AverageRocketPower = QuantizeUnsigned(InSample.AverageRocketPower);
+
+	Result.RocketPowers.Reserve(InSample.RocketPowers.Num());
+	for (const float RocketPower : InSample.RocketPowers)
+	{
+		Result.RocketPowers.Add(QuantizeUnsigned(RocketPower));
+	}
+
+	return Result;
+}
+
+FSGSM_ShipStateSample FSGSM_QuantizedShipState::Dequantize() const
+{
+	FSGSM_ShipStateSample Result;
+	Result.Location = FVector(Location) * LocationResolution;
+	Result.LinearVelocity = FVector(Velocity) * VelocityResolution;
+	Result.Yaw = FRotator::DecompressAxisFromShort(Yaw);
+	Result.YawRate = YawRate * YawRateResolution;
+
+	Result.LinearThrustNormal = FVector2D(LinearThrustX / 127.0, LinearThrustY / 127.0);
+	Result.YawTorqueNormalized = YawTorque / 127.0;
+	Result.AverageRocketPower = AverageRocketPower / 255.0;
+
+	Result.RocketPowers.Reserve(RocketPowers.Num());
+	for (const uint8 RocketPower : RocketPowers)
+	{
+		Result.RocketPowers.Add(RocketPower / 255.f);
+	}
+
+	return Result;
+}
+
+bool FSGSM_QuantizedShipState::HasSameState(const FSGSM_QuantizedShipState& Other) const
+{
+	return Location == Other.Location
+		&& Velocity == Other.Velocity
+		&& Yaw == Other.Yaw
+		&& YawRate == Other.YawRate
+		&& SGSM_ShipStateSnapshot::HasSameThrust(*this, Other)
+		&& RocketPowers == Other.RocketPowers;
+}
+
+void FSGSM_QuantizedShipState::Write(FArchive& Ar, const FSGSM_QuantizedShipState* InBaseline) const
+{
+	using namespace SGSM_ShipStateSnapshot;
+
+	static const FSGSM_QuantizedShipState ZeroBaseline;
+	const FSGSM_QuantizedShipState& Baseline = InBaseline ? *InBaseline : ZeroBaseline;
+
+	uint8 Changed = InBaseline ? HasBaseline : 0;
+	Changed |= Location != Baseline.Location ? EChangedFields::Location : 0;
+	Changed |= Velocity != Baseline.Velocity ? EChangedFields::Velocity : 0;
+	Changed |= Yaw != Baseline.Yaw ? EChangedFields::Yaw : 0;
+	Changed |= YawRate != Baseline.YawRate ? EChangedFields::YawRate : 0;
+	Changed |= !HasSameThrust(*this, Baseline) ? EChangedFields::Thrust : 0;
+	Changed |= RocketPowers != Baseline.RocketPowers ? EChangedFields::Rockets : 0;
+
+	// Fields go through copies, the archive operators take references and writing never changes the state.
+	uint16 WrittenSequence = Sequence;
+	Ar << WrittenSequence;
+	Ar.SerializeBits(&Changed, NumFieldBits);
+
+	if (Changed & HasBaseline)
+	{
+		uint16 BaselineSequence = Baseline.Sequence;
+		Ar << BaselineSequence;
+	}
+
+	if (Changed & EChangedFields::Location)
+	{
+		FIntVector Value = Location;
+		SerializeDelta(Ar, Value, Baseline.Location);
+	}
+	if (Changed & EChangedFields::Velocity)
+	{
+		FIntVector Value = Velocity;
+		SerializeDelta(Ar, Value, Baseline.Velocity);
+	}
+	if (Changed & EChangedFields::Yaw)
+	{
+		uint16 Value = Yaw;
+		Ar << Value;
+	}
+	if (Changed & EChangedFields::YawRate)
+	{
+		int32 Value = YawRate;
+		SerializeDelta(Ar, Value, Baseline.YawRate);
+	}
+	if (Changed & EChangedFields::Thrust)
+	{
+		int8 ThrustX = LinearThrustX;
+		int8 ThrustY = LinearThrustY;
+		int8 Torque = YawTorque;
+		uint8 RocketPower = AverageRocketPower;
+		Ar << ThrustX << ThrustY << Torque << RocketPower;
+	}
+	if (Changed & EChangedFields::Rockets)
+	{
+		uint32 NumRockets = RocketPowers.Num();
+		Ar.SerializeIntPacked(NumRockets);
+
+		// Non-zero bitfield, then one byte per firing rocket.
+		for (uint32 Index = 0; Index < NumRockets; ++Index)
+		{
+			uint8 bFiring = RocketPowers[Index] != 0 ? 1 : 0;
+			Ar.SerializeBits(&bFiring, 1);
+		}
+		for (uint8 RocketPower : RocketPowers)
+		{
+			if (RocketPower != 0)
+			{
+				Ar << RocketPower;
+			}
+		}
+	}
+}
+
+bool FSGSM_QuantizedShipState::Read(FArchive& Ar, TFunctionRef<const FSGSM_QuantizedShipState*(uint16)> InFindBaseline)
+{
+	using namespace SGSM_ShipStateSnapshot;
+
+	uint8 Changed = 0;
+	Ar << Sequence;
+	Ar.SerializeBits(&Changed, NumFieldBits);
+
+	static const FSGSM_QuantizedShipState ZeroBaseline;
+	const FSGSM_QuantizedShipState* Baseline = &ZeroBaseline;
+	bool bHasBaseline = true;
+
+	if (Changed & HasBaseline)
+	{
+		uint16 BaselineSequence = 0;
+		Ar << BaselineSequence;
+		Baseline = InFindBaseline(BaselineSequence);
+		if (!Baseline)
+		{
+			bHasBaseline = false;
+			Baseline = &ZeroBaseline;
+		}
+	}
+
+	// Unchanged fields come from the baseline.
+	Location = Baseline->Location;
+	Velocity = Baseline->Velocity;
+	Yaw = Baseline->Yaw;
+	YawRate = Baseline->YawRate;
+	LinearThrustX = Baseline->LinearThrustX;
+	LinearThrustY = Baseline->LinearThrustY;
+	YawTorque = Baseline->YawTorque;
+	AverageRocketPower = Baseline->AverageRocketPower;
+	RocketPowers = Baseline->RocketPowers;
+
+	if (Changed & EChangedFields::Location)
+	{
+		SerializeDelta(Ar, Location, Baseline->Location);
+	}
+	if (Changed & EChangedFields::Velocity)
+	{
+		SerializeDelta(Ar, Velocity, Baseline->Velocity);
+	}
+	if (Changed & EChangedFields::Yaw)
+	{
+		Ar << Yaw;
+	}
+	if (Changed & EChangedFields::YawRate)
+	{
+		int32 Value = 0;
+		SerializeDelta(Ar, Value, Baseline->YawRate);
+		YawRate = static_cast<int16>(Value);
+	}
+	if (Changed & EChangedFields::Thrust)
+	{
+		Ar << LinearThrustX << LinearThrustY << YawTorque << AverageRocketPower;
+	}
+	if (Changed & EChangedFields::Rockets)
+	{
+		uint32 NumRockets = 0;
+		Ar.SerializeIntPacked(NumRockets);
+		if (NumRockets > 1024)
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		RocketPowers.SetNumZeroed(NumRockets);
+		TArray<bool, TInlineAllocator<64>> Firing;
+		Firing.SetNumZeroed(NumRockets);
+		for (uint32 Index = 0; Index < NumRockets; ++Index)
+		{
+			uint8 bFiring = 0;
+			Ar.SerializeBits(&bFiring, 1);
+			Firing[Index] = bFiring != 0;
+		}
+		for (uint32 Index = 0; Index < NumRockets; ++Index)
+		{
+			if (Firing[Index])
+			{
+				Ar << RocketPowers[Index];
+			}
+		}
+	}
+
+	return bHasBaseline && !Ar.IsError();
+}
+
+namespace SGSM_ShipStateSnapshot
+{
+	class FDeltaBaseState : public INetDeltaBaseState
+	{
+	public:
+
+		virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+		{
+			const FDeltaBaseState* const Other = static_cast<FDeltaBaseState*>(OtherState);
+			return Other && State.Sequence == Other->State.Sequence;
+		}
+
+		FSGSM_QuantizedShipState State;
+	};
+}
+
+void FSGSM_ReplicatedShipState::SetState(const FSGSM_QuantizedShipState& InState)
+{
+	if (State.HasSameState(InState))
+	{
+		return;
+	}
+
+	const uint16 NextSequence = State.Sequence + 1;
+	State = InState;
+	State.Sequence = NextSequence;
+}
+
+const FSGSM_QuantizedShipState* FSGSM_ReplicatedShipState::FindHistory(uint16 InSequence) const
+{
+	for (const FSGSM_QuantizedShipState& Entry : History)
+	{
+		if (Entry.Sequence == InSequence)
+		{
+			return &Entry;
+		}
+	}
+	return nullptr;
+}
+
+void FSGSM_ReplicatedShipState::WriteState(FArchive& Ar, const FSGSM_QuantizedShipState* InAckedBaseline, FSGSM_QuantizedShipState& OutNewBaseline) const
+{
+	// The receiver keeps every distinct state it got, at most one per sequence since the baseline. Once that can exceed
+	// its history the baseline may be gone, so the state goes out in full and the receiver resyncs from it.
+	const bool bBaselineInWindow = InAckedBaseline && static_cast<uint16>(State.Sequence - InAckedBaseline->Sequence) < HistorySize;
+
+	State.Write(Ar, bBaselineInWindow ? InAckedBaseline : nullptr);
+
+	// Once acknowledged, the state just written is what the next write is delta-encoded against.
+	OutNewBaseline = State;
+}
+
+bool FSGSM_ReplicatedShipState::ReceiveState(FArchive& Ar, bool& bOutApplied)
+{
+	FSGSM_QuantizedShipState Received;
+	bOutApplied = Received.Read(Ar, [this](uint16 InSequence) { return FindHistory(InSequence); });
+
+	if (Ar.IsError())
+	{
+		bOutApplied = false;
+		return false;
+	}
+
+	// The record is consumed either way, failing the bunch would only get the connection closed.
+	UE_CLOG(!bOutApplied, SMLogNet, Warning, TEXT("Skipped ship state %d, its baseline is no longer in the history"), Received.Sequence);
+	if (!bOutApplied)
+	{
+		return true;
+	}
+
+	State = Received;
+
+	// Resent states are kept once, so the history always spans HistorySize distinct sequences.
+	if (FindHistory(Received.Sequence))
+	{
+		return true;
+	}
+
+	if (History.Num() < HistorySize)
+	{
+		History.Add(Received);
+	}
+	else
+	{
+		History[HistoryHead] = Received;
+		HistoryHead = (HistoryHead + 1) % HistorySize;
+	}
+	return true;
+}
+
+bool FSGSM_ReplicatedShipState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	using namespace SGSM_ShipStateSnapshot;
+
+	if (DeltaParms.Writer)
+	{
+		const FDeltaBaseState* const OldState = static_cast<FDeltaBaseState*>(DeltaParms.OldState);
+		if (OldState && OldState->State.Sequence == State.Sequence)
+		{
+			return false;
+		}
+
+		TSharedPtr<FDeltaBaseState> NewState = MakeShared<FDeltaBaseState>();
+		WriteState(*DeltaParms.Writer, OldState ? &OldState->State : nullptr, NewState->State);
+		*DeltaParms.NewState = NewState;
+		return true;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		bool bApplied = false;
+		return ReceiveState(*DeltaParms.Reader, bApplied);
+	}
+
+	return true;
+}
+
+/*
+ * Encodes a synthetic fleet the way FSGSM_ReplicatedShipState replicates it and reports the bytes per ship per second,
+ * next to the size of the same state at full precision.
+ * Then checks that a receiver resyncs when the acked baseline is older than its history and skips a state against an evicted one.
+ * Usage: sgsm.Net.MeasureSnapshotBandwidth [NumShips=200] [Seconds=10] [UpdateHz=30] [RocketsPerShip=8]
+ */
+static FAutoConsoleCommand GSGSM_MeasureSnapshotBandwidthCommand(
+	TEXT("sgsm.Net.MeasureSnapshotBandwidth"),
+	TEXT("Measures delta-compressed ship state bytes per ship per second on a synthetic fleet. Args: [NumShips] [Seconds] [UpdateHz] [RocketsPerShip]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const int32 NumShips = Args.IsValidIndex(0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const double Seconds = Args.IsValidIndex(1) ? FMath::Max(0.1, FCString::Atod(*Args[1])) : 10.0;
+		const int32 UpdateHz = Args.IsValidIndex(2) ? FMath::Max(1, FCString::Atoi(*Args[2])) : 30;
+		const int32 RocketsPerShip = Args.IsValidIndex(3) ? FMath::Max(0, FCString::Atoi(*Args[3])) : 8;
+
+		const double DeltaTime = 1.0 / UpdateHz;
+		const int32 NumSteps = FMath::CeilToInt(Seconds * UpdateHz);
+
+		FRandomStream Random(1337);
+		TArray<FSGSM_ShipStateSample> Samples;
+		TArray<FSGSM_QuantizedShipState> Acked;
+		Samples.SetNum(NumShips);
+		Acked.SetNum(NumShips);
+
+		for (FSGSM_ShipStateSample& Sample : Samples)
+		{
+			Sample.Location = Random.GetUnitVector() * Random.FRandRange(0.0, 500000.0);
+			Sample.Location.Z = 0.0;
+			Sample.Yaw = Random.FRandRange(-180.0, 180.0);
+			Sample.RocketPowers.SetNumZeroed(RocketsPerShip);
+		}
+
+		int64 TotalBits = 0;
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			for (int32 ShipIndex = 0; ShipIndex < NumShips; ++ShipIndex)
+			{
+				FSGSM_ShipStateSample& Sample = Samples[ShipIndex];
+
+				// Ships cruise, occasionally changing thrust and boosting.
+				if (Random.FRand() < 0.05)
+				{
+					Sample.LinearThrustNormal = FVector2D(Random.FRandRange(-1.0, 1.0), Random.FRandRange(-1.0, 1.0));
+					Sample.YawTorqueNormalized = Random.FRandRange(-1.0, 1.0);
+					const bool bBoosting = Random.FRand() < 0.3;
+					for (float& RocketPower : Sample.RocketPowers)
+					{
+						RocketPower = bBoosting ? Random.FRand() : 0.f;
+					}
+					Sample.AverageRocketPower = bBoosting ? 0.5 : 0.0;
+				}
+
+				Sample.LinearVelocity += FVector(Sample.LinearThrustNormal, 0.0) * 200.0 * DeltaTime;
+				Sample.Location += Sample.LinearVelocity * DeltaTime;
+				Sample.YawRate = FMath::Clamp(Sample.YawRate + Sample.YawTorqueNormalized * 30.0 * DeltaTime, -90.0, 90.0);
+				Sample.Yaw = FRotator::NormalizeAxis(Sample.Yaw + Sample.YawRate * DeltaTime);
+
+				FSGSM_QuantizedShipState Current = FSGSM_QuantizedShipState::Quantize(Sample);
+				if (Current.HasSameState(Acked[ShipIndex]) && Step > 0)
+				{
+					continue;
+				}
+				Current.Sequence = Acked[ShipIndex].Sequence + 1;
+
+				FBitWriter Writer(0, true);
+				Current.Write(Writer, Step > 0 ? &Acked[ShipIndex] : nullptr);
+				TotalBits += Writer.GetNumBits();
+
+				// Every update is assumed acknowledged before the next one.
+				Acked[ShipIndex] = Current;
+			}
+		}
+
+		const double BytesPerShipPerSecond = (TotalBits / 8.0) / NumShips / Seconds;
+
+		// Doubles for location, velocity, yaw, yaw rate and the three thrust values, floats per rocket.
+		const double FullBytesPerUpdate = (3 + 3 + 2 + 4) * sizeof(double) + RocketsPerShip * sizeof(float);
+		const double FullBytesPerShipPerSecond = FullBytesPerUpdate * UpdateHz;
+
+		UE_LOG(SMLogNet, Display, TEXT("Ship state snapshots: %d ships, %.1f s at %d Hz, %d rockets each"), NumShips, Seconds, UpdateHz, RocketsPerShip);
+		UE_LOG(SMLogNet, Display, TEXT("  delta-compressed: %.1f bytes/ship/s (%.1f KB/s fleet)"), BytesPerShipPerSecond, BytesPerShipPerSecond * NumShips / 1024.0);
+		UE_LOG(SMLogNet, Display, TEXT("  full precision:   %.1f bytes/ship/s (%.1fx)"), FullBytesPerShipPerSecond, FullBytesPerShipPerSecond / FMath::Max(BytesPerShipPerSecond, UE_DOUBLE_SMALL_NUMBER));
+
+		// A connection whose acks stall past the history window: every state is sent against the same stale baseline
+		// while the receiver keeps getting them, so that baseline falls out of its history. All of them must still apply.
+		FSGSM_ReplicatedShipState Sender;
+		FSGSM_ReplicatedShipState Receiver;
+		FSGSM_ShipStateSample StaleSample = Samples[0];
+
+		auto SendState = [&Sender, &Receiver](const FSGSM_QuantizedShipState* InAckedBaseline, bool& bOutApplied)
+		{
+			FBitWriter Writer(0, true);
+			FSGSM_QuantizedShipState NewBaseline;
+			Sender.WriteState(Writer, InAckedBaseline, NewBaseline);
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			return Receiver.ReceiveState(Reader, bOutApplied) && Reader.GetPosBits() == Writer.GetNumBits();
+		};
+
+		bool bApplied = false;
+		Sender.SetState(FSGSM_QuantizedShipState::Quantize(StaleSample));
+		SendState(nullptr, bApplied);
+		const FSGSM_QuantizedShipState StaleAck = Sender.GetState();
+
+		const int32 NumStaleSends = FSGSM_ReplicatedShipState::HistorySize + 8;
+		int32 NumStaleApplied = 0;
+		bool bStaleConsumed = true;
+		for (int32 Send = 0; Send < NumStaleSends; ++Send)
+		{
+			StaleSample.Location.X += 100.0;
+			Sender.SetState(FSGSM_QuantizedShipState::Quantize(StaleSample));
+			bStaleConsumed &= SendState(&StaleAck, bApplied);
+			NumStaleApplied += bApplied && Receiver.GetState().Sequence == Sender.GetState().Sequence ? 1 : 0;
+		}
+
+		// A state forced against a baseline the receiver already evicted must be consumed and skipped, not fail the bunch.
+		FSGSM_QuantizedShipState EvictedBaseline = StaleAck;
+		EvictedBaseline.Sequence = static_cast<uint16>(Sender.GetState().Sequence - FSGSM_ReplicatedShipState::HistorySize - 4);
+		const uint16 ReceivedSequence = Receiver.GetState().Sequence;
+		StaleSample.Location.X += 100.0;
+		Sender.SetState(FSGSM_QuantizedShipState::Quantize(StaleSample));
+
+		FBitWriter ForcedWriter(0, true);
+		Sender.GetState().Write(ForcedWriter, &EvictedBaseline);
+		FBitReader ForcedReader(ForcedWriter.GetData(), ForcedWriter.GetNumBits());
+		const bool bForcedConsumed = Receiver.ReceiveState(ForcedReader, bApplied) && ForcedReader.GetPosBits() == ForcedWriter.GetNumBits();
+		const bool bForcedSkipped = !bApplied && Receiver.GetState().Sequence == ReceivedSequence;
+
+		UE_LOG(SMLogNet, Display, TEXT("  out-of-window baseline: %d/%d states applied, %s"), NumStaleApplied, NumStaleSends, bStaleConsumed ? TEXT("all consumed") : TEXT("READ FAILED"));
+		UE_LOG(SMLogNet, Display, TEXT("  evicted baseline: %s, %s"), bForcedConsumed ? TEXT("consumed") : TEXT("READ FAILED"), bForcedSkipped ? TEXT("skipped") : TEXT("WRONGLY APPLIED"));
+	}));
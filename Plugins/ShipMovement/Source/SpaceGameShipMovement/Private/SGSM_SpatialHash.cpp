@@ -0,0 +1,96 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_SpatialHash.h"
+#include "Misc/AutomationTest.h"
+
+
+void FSGSM_SpatialHash::Build(TConstArrayView<FVector> InPoints, double InCellSize)
+{
+	ensureAlwaysMsgf(InCellSize > 0.0, TEXT("Spatial hash cell size must be positive"));
+	InvCellSize = 1.0 / FMath::Max(InCellSize, UE_KINDA_SMALL_NUMBER);
+
+	Points = InPoints;
+
+	// About two buckets per point keeps collisions rare without a sparse table.
+	const uint32 NumBuckets = FMath::RoundUpToPowerOfTwo(FMath::Max(2 * Points.Num(), 64));
+	BucketMask = NumBuckets - 1;
+
+	BucketStart.Reset();
+	BucketStart.SetNumZeroed(NumBuckets + 1);
+	PointBuckets.SetNumUninitialized(Points.Num(), EAllowShrinking::No);
+	PointCells.SetNumUninitialized(Points.Num(), EAllowShrinking::No);
+	SortedIndices.SetNumUninitialized(Points.Num(), EAllowShrinking::No);
+	SortedCells.SetNumUninitialized(Points.Num(), EAllowShrinking::No);
+
+	// Count points per bucket.
+	for (int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex)
+	{
+		const FIntPoint Cell = GetCell(Points[PointIndex]);
+		const uint32 Bucket = GetBucket(Cell.X, Cell.Y);
+		PointBuckets[PointIndex] = Bucket;
+		PointCells[PointIndex] = Cell;
+		++BucketStart[Bucket + 1];
+	}
+
+	for (uint32 Bucket = 1; Bucket <= NumBuckets; ++Bucket)
+	{
+		BucketStart[Bucket] += BucketStart[Bucket - 1];
+	}
+
+	// Scatter, using a copy of the starts as write cursors.
+	BucketCursors.Reset();
+	BucketCursors.Append(BucketStart.GetData(), NumBuckets);
+
+	for (int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex)
+	{
+		const int32 Entry = BucketCursors[PointBuckets[PointIndex]]++;
+		SortedIndices[Entry] = PointIndex;
+		SortedCells[Entry] = PointCells[PointIndex];
+	}
+}
+
+void FSGSM_SpatialHash::Reset()
+{
+	Points.Reset();
+	SortedIndices.Reset();
+	PointBuckets.Reset();
+	PointCells.Reset();
+	SortedCells.Reset();
+	BucketStart.Reset();
+	BucketCursors.Reset();
+	BucketMask = 0;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGSM_SpatialHashVisitOnceTest, "SpaceGameShipMovement.SpatialHash.VisitsEachPointOnce",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::EngineFilter)
+
+bool FSGSM_SpatialHashVisitOnceTest::RunTest(const FString& Parameters)
+{
+	// A few points in a 64 bucket table queried over 41 x 41 cells, so many cells of the range share a bucket.
+	TArray<FVector> Points;
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		Points.Emplace(Index * 3.0 - 10.0, Index * -2.0 + 5.0, 0.0);
+	}
+
+	FSGSM_SpatialHash SpatialHash;
+	SpatialHash.Build(Points, 1.0);
+
+	TArray<int32> VisitCounts;
+	VisitCounts.SetNumZeroed(Points.Num());
+	SpatialHash.Query(FVector::ZeroVector, 20.0, [&VisitCounts](int32 PointIndex, double DistanceSquared)
+	{
+		++VisitCounts[PointIndex];
+		return true;
+	});
+
+	for (int32 Index = 0; Index < Points.Num(); ++Index)
+	{
+		TestEqual(FString::Printf(TEXT("Visits of point %d"), Index), VisitCounts[Index], 1);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,31 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_Stats.h"
+
+
+DEFINE_STAT(STAT_SGSM_PropulsionStep);
+DEFINE_STAT(STAT_SGSM_StepShip);
+DEFINE_STAT(STAT_SGSM_PhysicsTickLinearThrust);
+DEFINE_STAT(STAT_SGSM_PhysicsTickLinearBrake);
+DEFINE_STAT(STAT_SGSM_PhysicsTickAngularThrust);
+DEFINE_STAT(STAT_SGSM_PhysicsTickAngularBrake);
+DEFINE_STAT(STAT_SGSM_PhysicsTickScreenRelativeAngularThrust);
+DEFINE_STAT(STAT_SGSM_PhysicsTickRocketThrust);
+
+DEFINE_STAT(STAT_SGSM_TickBoosting);
+DEFINE_STAT(STAT_SGSM_PropulsionStatus);
+
+DEFINE_STAT(STAT_SGSM_MassPropulsion);
+DEFINE_STAT(STAT_SGSM_MassConversion);
+DEFINE_STAT(STAT_SGSM_MassShips);
+
+DEFINE_STAT(STAT_SGSM_FleetSteering);
+DEFINE_STAT(STAT_SGSM_FleetShips);
+
+DEFINE_STAT(STAT_SGSM_ActiveShips);
+DEFINE_STAT(STAT_SGSM_MidShips);
+DEFINE_STAT(STAT_SGSM_FarShips);
+DEFINE_STAT(STAT_SGSM_DormantShips);
+DEFINE_STAT(STAT_SGSM_BrakingShips);
+DEFINE_STAT(STAT_SGSM_FiringRockets);
+DEFINE_STAT(STAT_SGSM_InputLatencyFrames);
@@ -0,0 +1,183 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_ThrustAllocator.h"
+#include "SGSM_RocketLayout.h"
+#include "SGSM_LogCategory.h"
+
+
+void FSGSM_ThrustAllocator::Build(const FSGSM_RocketLayout& InLayout)
+{
+	Reset();
+
+	const int32 NumRockets = InLayout.Num();
+	if (NumRockets == 0)
+	{
+		return;
+	}
+
+	Columns.SetNumUninitialized(NumRockets);
+	for (int32 Index = 0; Index < NumRockets; ++Index)
+	{
+		Columns[Index] = MakeColumn(InLayout, Index);
+		AddToGram(Columns[Index], 1.0);
+	}
+
+	UE_CLOG(!UpdateInverse(), SMLogBrain, Warning, TEXT("Thrust allocator: rocket layout has no thrust authority"));
+}
+
+void FSGSM_ThrustAllocator::Reset()
+{
+	Columns.Reset();
+	FMemory::Memzero(Gram);
+	FMemory::Memzero(Inverse);
+	bHasInverse = false;
+}
+
+void FSGSM_ThrustAllocator::AddRocket(const FSGSM_RocketLayout& InLayout, int32 InEntry)
+{
+	if (!ensureAlwaysMsgf(InEntry == Columns.Num(), TEXT("Thrust allocator is out of sync with its rocket layout")))
+	{
+		Build(InLayout);
+		return;
+	}
+
+	AddToGram(Columns.Add_GetRef(MakeColumn(InLayout, InEntry)), 1.0);
+	UpdateInverse();
+}
+
+void FSGSM_ThrustAllocator::RemoveRocketAtSwap(int32 InEntry)
+{
+	if (!ensureAlwaysMsgf(Columns.IsValidIndex(InEntry), TEXT("Thrust allocator is out of sync with its rocket layout")))
+	{
+		return;
+	}
+
+	AddToGram(Columns[InEntry], -1.0);
+	Columns.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+
+	// Subtracting columns leaves rounding residue, an empty layout starts over exactly.
+	if (Columns.IsEmpty())
+	{
+		Reset();
+		return;
+	}
+
+	UpdateInverse();
+}
+
+void FSGSM_ThrustAllocator::UpdateRocket(const FSGSM_RocketLayout& InLayout, int32 InEntry)
+{
+	if (!ensureAlwaysMsgf(Columns.IsValidIndex(InEntry), TEXT("Thrust allocator is out of sync with its rocket layout")))
+	{
+		return;
+	}
+
+	AddToGram(Columns[InEntry], -1.0);
+	Columns[InEntry] = MakeColumn(InLayout, InEntry);
+	AddToGram(Columns[InEntry], 1.0);
+
+	UpdateInverse();
+}
+
+FVector FSGSM_ThrustAllocator::MakeColumn(const FSGSM_RocketLayout& InLayout, int32 InEntry)
+{
+	const FVector Force = InLayout.LocalForward[InEntry] * InLayout.MaxThrust[InEntry];
+	const double YawTorque = FVector::CrossProduct(InLayout.MountOffset[InEntry], Force).Z;
+	return FVector(Force.X, Force.Y, YawTorque);
+}
+
+void FSGSM_ThrustAllocator::AddToGram(const FVector& InColumn, double InSign)
+{
+	for (int32 Row = 0; Row < 3; ++Row)
+	{
+		for (int32 Col = 0; Col < 3; ++Col)
+		{
+			Gram[Row][Col] += InSign * InColumn[Row] * InColumn[Col];
+		}
+	}
+}
+
+bool FSGSM_ThrustAllocator::UpdateInverse()
+{
+	bHasInverse = false;
+
+	const double Trace = Gram[0][0] + Gram[1][1] + Gram[2][2];
+	if (Trace <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	double M[3][3];
+	FMemory::Memcpy(M, Gram);
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		M[Axis][Axis] += Trace * Damping;
+	}
+
+	const double Cofactor00 = M[1][1] * M[2][2] - M[1][2] * M[2][1];
+	const double Cofactor01 = M[1][2] * M[2][0] - M[1][0] * M[2][2];
+	const double Cofactor02 = M[1][0] * M[2][1] - M[1][1] * M[2][0];
+	const double Determinant = M[0][0] * Cofactor00 + M[0][1] * Cofactor01 + M[0][2] * Cofactor02;
+
+	if (FMath::Abs(Determinant) <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const double InvDeterminant = 1.0 / Determinant;
+	Inverse[0][0] = Cofactor00 * InvDeterminant;
+	Inverse[1][0] = Cofactor01 * InvDeterminant;
+	Inverse[2][0] = Cofactor02 * InvDeterminant;
+	Inverse[0][1] = (M[0][2] * M[2][1] - M[0][1] * M[2][2]) * InvDeterminant;
+	Inverse[1][1] = (M[0][0] * M[2][2] - M[0][2] * M[2][0]) * InvDeterminant;
+	Inverse[2][1] = (M[0][1] * M[2][0] - M[0][0] * M[2][1]) * InvDeterminant;
+	Inverse[0][2] = (M[0][1] * M[1][2] - M[0][2] * M[1][1]) * InvDeterminant;
+	Inverse[1][2] = (M[0][2] * M[1][0] - M[0][0] * M[1][2]) * InvDeterminant;
+	Inverse[2][2] = (M[0][0] * M[1][1] - M[0][1] * M[1][0]) * InvDeterminant;
+
+	bHasInverse = true;
+	return true;
+}
+
+FVector FSGSM_ThrustAllocator::Solve(const FVector& InWrench) const
+{
+	// B^+ * w = B^T * (M^-1 * w), so the per-rocket work stays a single dot product.
+	return FVector(
+		Inverse[0][0] * InWrench.X + Inverse[0][1] * InWrench.Y + Inverse[0][2] * InWrench.Z,
+		Inverse[1][0] * InWrench.X + Inverse[1][1] * InWrench.Y + Inverse[1][2] * InWrench.Z,
+		Inverse[2][0] * InWrench.X + Inverse[2][1] * InWrench.Y + Inverse[2][2] * InWrench.Z);
+}
+
+void FSGSM_ThrustAllocator::Allocate(const FVector& InLocalForce, double InYawTorque, TArray<double>& OutThrottles) const
+{
+	const int32 NumRockets = Num();
+	OutThrottles.SetNumUninitialized(NumRockets, EAllowShrinking::No);
+
+	const FVector Solved = Solve(FVector(InLocalForce.X, InLocalForce.Y, InYawTorque));
+
+	for (int32 Index = 0; Index < NumRockets; ++Index)
+	{
+		OutThrottles[Index] = FMath::Clamp(FVector::DotProduct(Columns[Index], Solved), 0.0, 1.0);
+	}
+}
+
+void FSGSM_ThrustAllocator::AllocateDirection(const FVector& InLocalDirection, double InScale, TArray<double>& OutThrottles) const
+{
+	const int32 NumRockets = Num();
+	OutThrottles.SetNumUninitialized(NumRockets, EAllowShrinking::No);
+
+	const FVector Solved = Solve(FVector(InLocalDirection.X, InLocalDirection.Y, 0.0));
+
+	double MaxThrottle = 0.0;
+	for (int32 Index = 0; Index < NumRockets; ++Index)
+	{
+		OutThrottles[Index] = FVector::DotProduct(Columns[Index], Solved);
+		MaxThrottle = FMath::Max(MaxThrottle, OutThrottles[Index]);
+	}
+
+	const double Scale = MaxThrottle > UE_DOUBLE_SMALL_NUMBER ? InScale / MaxThrottle : 0.0;
+	for (double& Throttle : OutThrottles)
+	{
+		Throttle = FMath::Clamp(Throttle * Scale, 0.0, 1.0);
+	}
+}
@@ -6,9 +6,11 @@
 #include "PhysicsProxy/SingleParticlePhysicsProxy.h"
 
 
-int32 SGSM_Utils::CentinewtonsPerNewton = 100;
-int32 SGSM_Utils::CentinewtonsPerKiloNewton = 100000;
-int32 SGSM_Utils::CentinewtonsPerMegaNewton = 100000000;
+int32 SGSM_Utils::CentinewtonsPerNewton = static_cast<int32>(SGSM_PropulsionMath::CentinewtonsPerNewton);
+int32 SGSM_Utils::CentinewtonsPerKiloNewton = static_cast<int32>(SGSM_PropulsionMath::CentinewtonsPerKiloNewton);
+int32 SGSM_Utils::CentinewtonsPerMegaNewton = static_cast<int32>(SGSM_PropulsionMath::CentinewtonsPerMegaNewton);
+
+const TCHAR* const SGSM_Utils::DemoShipClassPath = TEXT("/SpaceGameShipMovement/Demo/BP_DemoShipPawn.BP_DemoShipPawn_C");
 
 SGSM_Utils::SGSM_Utils()
 {
@@ -35,7 +37,7 @@ Chaos::FRigidBodyHandle_Internal* SGSM_Utils::GetRigidBodyHandle(const UPrimitiv
 
 	FPhysicsActorHandle Handle = BI->GetPhysicsActorHandle();
 
-	return Handle->GetPhysicsThreadAPI();
+	return Handle ? Handle->GetPhysicsThreadAPI() : nullptr;
 }
 
 double SGSM_Utils::GetNewtonToCentiNewtons(const double& InNewton)
@@ -52,34 +54,29 @@ double SGSM_Utils::GetMegaNewtonToCentiNewtons(const double& InMegaNewton)
 	return InMegaNewton * CentinewtonsPerMegaNewton;
 }
 
-FVector SGSM_Utils::GetThrustEngagementVector(const FVector& ForwardVector, const FVector& InDirection, const TMap<EDirection, double>& InDirectionMultiplier)
+FVector SGSM_Utils::GetThrustEngagementVector(const FVector& ForwardVector, const FVector& InDirection, const FSGSM_DirectionMultipliers& InDirectionMultiplier)
 {
-	if (InDirectionMultiplier.IsEmpty())
+	if (!InDirectionMultiplier.IsEnabled())
 	{
 		return FVector::ZeroVector;
 	}
 
-	FVector ThrustEngagmentVector = ForwardVector.Rotation().GetInverse().RotateVector(InDirection);
+	using namespace SGSM_PropulsionMath;
 
-	if (ThrustEngagmentVector.X < 0 && InDirectionMultiplier.Contains(EDirection::Front))
-	{
-		ThrustEngagmentVector.X *= InDirectionMultiplier[EDirection::Front];
-	}
-	else if (ThrustEngagmentVector.X > 0 && InDirectionMultiplier.Contains(EDirection::Back))
-	{
-		ThrustEngagmentVector.X *= InDirectionMultiplier[EDirection::Back];
-	}
+	// Roll-free orientation of the forward vector, built directly as a quaternion.
+	const FQuat Rotation = ForwardVector.ToOrientationQuat();
 
-	if (ThrustEngagmentVector.Y < 0 && InDirectionMultiplier.Contains(EDirection::Right))
-	{
-		ThrustEngagmentVector.Y *= InDirectionMultiplier[EDirection::Right];
-	}
-	else if (ThrustEngagmentVector.Y > 0 && InDirectionMultiplier.Contains(EDirection::Left))
-	{
-		ThrustEngagmentVector.Y *= InDirectionMultiplier[EDirection::Left];
-	}
+	return ToVector(GetThrustEngagement(ToMath(Rotation), ToMath(InDirection), InDirectionMultiplier.GetScale(), FDirectionScale(), 0.0));
+}
+
+FVector SGSM_Utils::GetThrustEngagementVector(const FQuat& InBodyRotation, const FVector& InDirection, const FSGSM_DirectionMultipliers& InThrustMultiplier, const FSGSM_DirectionMultipliers& InBoostMultiplier, double InBoostScale)
+{
+	using namespace SGSM_PropulsionMath;
 
-	ThrustEngagmentVector = ForwardVector.Rotation().RotateVector(ThrustEngagmentVector);
+	return ToVector(GetThrustEngagement(ToMath(InBodyRotation), ToMath(InDirection), InThrustMultiplier.GetScale(), InBoostMultiplier.GetScale(), InBoostScale));
+}
 
-	return ThrustEngagmentVector;
+FVector SGSM_Utils::GetThrustEngagementVector(const FVector& ForwardVector, const FVector& InDirection, const TMap<EDirection, double>& InDirectionMultiplier)
+{
+	return GetThrustEngagementVector(ForwardVector, InDirection, FSGSM_DirectionMultipliers::Compile(InDirectionMultiplier));
 }
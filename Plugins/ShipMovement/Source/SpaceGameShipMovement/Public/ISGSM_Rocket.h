@@ -19,6 +19,7 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "SGSM Rocket Interface")
 	double GetCurrentEfficiencyMultiplier() const;
 
+	/** Native fast path, called directly by USGSM_RocketComponent without going through reflection. */
 	UFUNCTION()
 	virtual double GetCurrentEfficiencyMultiplierPure() const = 0;
 
@@ -0,0 +1,79 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGSM_InputTrace.h"
+#include "SGSM_BenchmarkCommandlet.generated.h"
+
+class APawn;
+class USGSM_PropulsionBrain;
+class UWorld;
+
+/*
+ * Headless propulsion benchmark. Spawns ships into an empty world, drives them with scripted pilot input for a fixed number of
+ * steps and writes propulsion step time, game thread time and allocations per ship count as CSV.
+ * With -Trace the ships replay a recorded input trace instead, looping it when the run is longer than the trace.
+ *
+ * UnrealEditor-Cmd <Project> -run=SGSM_Benchmark -nullrhi -unattended
+ *     [-Ships=1,10,100,1000,5000] [-Steps=600] [-Warmup=60] [-DeltaTime=0.016667]
+ *     [-ShipClass=/SpaceGameShipMovement/Demo/BP_DemoShipPawn.BP_DemoShipPawn_C] [-Pattern=Mixed|Thrust|Boost|Brake|AltTurn] [-Trace=<file.sgtrace>] [-Output=<file.csv>]
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_BenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	USGSM_BenchmarkCommandlet(const FObjectInitializer& ObjectInitializer);
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	enum class EInputPattern : uint8
+	{
+		Mixed,
+		Thrust,
+		Boost,
+		Brake,
+		AltTurn
+	};
+
+	struct FRunResult
+	{
+		int32 NumShips = 0;
+		int32 NumSteps = 0;
+		double PropulsionStepMeanMs = 0.0;
+		double PropulsionStepP99Ms = 0.0;
+		double GameThreadMeanMs = 0.0;
+		double GameThreadP99Ms = 0.0;
+		double AllocationsPerFrame = 0.0;
+		double UsedMemoryDeltaMB = 0.0;
+	};
+
+	/** Runs one benchmark pass with InNumShips ships in a fresh world. */
+	bool RunPass(UClass* InShipClass, int32 InNumShips, FRunResult& OutResult) const;
+
+	static UWorld* CreateBenchmarkWorld();
+	static void DestroyBenchmarkWorld(UWorld* InWorld);
+
+	/** Scripted pilot input of one ship for one step, deterministic in the ship index and step. */
+	void DriveShip(USGSM_PropulsionBrain* InPropulsionBrain, int32 InShipIndex, int32 InStep) const;
+
+	static double GetMean(const TArray<double>& InSamples);
+	static double GetPercentile(TArray<double> InSamples, double InPercentile);
+
+	TArray<int32> ShipCounts;
+	int32 NumSteps = 600;
+	int32 NumWarmupSteps = 60;
+	float DeltaTime = 1.f / 60.f;
+	EInputPattern Pattern = EInputPattern::Mixed;
+
+	// Recorded input replayed instead of Pattern when loaded from -Trace.
+	FSGSM_InputTrace Trace;
+	bool bUseTrace = false;
+
+};
@@ -0,0 +1,160 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_SpatialHash.h"
+#include "SGSM_FleetSubsystem.generated.h"
+
+class USGSM_PropulsionBrain;
+
+/*
+ * Steering weights and limits of one fleet.
+ */
+USTRUCT(BlueprintType)
+struct FSGSM_FleetSteeringSettings
+{
+	GENERATED_BODY()
+
+	// Speed the fleet steers for, in cm/s. Thrust saturates once the velocity error reaches it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "1"))
+	float CruiseSpeed = 5000.f;
+
+	// Fleet mates within this distance are aligned with and cohere to.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "1"))
+	float NeighborRadius = 10000.f;
+
+	// Any ship, of any fleet, within this distance is steered away from.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "1"))
+	float SeparationRadius = 3000.f;
+
+	// Neighbors considered per ship, bounds the cost of dense clusters.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "1"))
+	int32 MaxNeighbors = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering")
+	float SeparationWeight = 1.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering")
+	float AlignmentWeight = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering")
+	float CohesionWeight = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering")
+	float FormationWeight = 2.f;
+
+	// Ships slow down within this distance of their formation slot.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "1"))
+	float SlotArriveDistance = 5000.f;
+
+	// Within this distance of a resting slot both brakes are engaged instead of thrusting.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fleet Steering", Meta = (ClampMin = "0"))
+	float SlotBrakeDistance = 200.f;
+};
+
+/*
+ * Stable handle to a fleet of USGSM_FleetSubsystem.
+ */
+struct FSGSM_FleetHandle
+{
+	int32 Id = INDEX_NONE;
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+	void Reset() { Id = INDEX_NONE; }
+};
+
+/*
+ * Group steering for AI fleets: separation, alignment, cohesion and formation slot following.
+ * Once per frame every fleet ship is gathered into a spatial hash, the steering of all ships is evaluated in parallel, and the
+ * result is applied to each ship's propulsion brain as pilot input. AI controllers only move the formation anchor.
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_FleetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static USGSM_FleetSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FSGSM_FleetHandle CreateFleet(const FSGSM_FleetSteeringSettings& InSettings);
+
+	/** Releases every ship of the fleet, leaving them idle. */
+	void DestroyFleet(FSGSM_FleetHandle& InOutFleet);
+
+	void SetFleetSettings(FSGSM_FleetHandle InFleet, const FSGSM_FleetSteeringSettings& InSettings);
+
+	/** Adds a ship to a fleet, moving it out of any fleet it was part of. Ships without a slot only flock. */
+	void AddShip(FSGSM_FleetHandle InFleet, USGSM_PropulsionBrain* InBrain, int32 InSlotIndex = INDEX_NONE);
+	void RemoveShip(USGSM_PropulsionBrain* InBrain);
+
+	/** Formation slots in anchor space, indexed by the slot index ships were added with. */
+	void SetFormation(FSGSM_FleetHandle InFleet, TConstArrayView<FVector> InSlotOffsets);
+
+	/** Moves the formation, slots follow the anchor transform and inherit its velocity. */
+	void SetFormationAnchor(FSGSM_FleetHandle InFleet, const FTransform& InAnchor, const FVector& InAnchorVelocity = FVector::ZeroVector);
+
+	int32 GetNumFleetShips() const { return Ships.Num(); }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FFleet
+	{
+		FSGSM_FleetSteeringSettings Settings;
+		TArray<FVector> SlotOffsets;
+		FTransform Anchor = FTransform::Identity;
+		FVector AnchorVelocity = FVector::ZeroVector;
+		bool bHasAnchor = false;
+	};
+
+	struct FFleetShip
+	{
+		TWeakObjectPtr<USGSM_PropulsionBrain> Brain;
+		// Kept apart from Brain so the entry can still be found once the brain is gone.
+		TObjectKey<USGSM_PropulsionBrain> Key;
+		int32 FleetId = INDEX_NONE;
+		int32 SlotIndex = INDEX_NONE;
+	};
+
+	/** Per-frame copy of a ship's state, the parallel steering pass only reads these. */
+	struct FShipSample
+	{
+		FVector Location = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+		FVector Forward = FVector::ForwardVector;
+		int32 FleetId = INDEX_NONE;
+		int32 SlotIndex = INDEX_NONE;
+	};
+
+	/** Game thread, copies the state of every fleet ship and drops ships whose brain is gone. */
+	void GatherSamples();
+
+	FSGSM_PilotInput ComputeSteering(int32 InShipIndex) const;
+
+	/** Swaps the last ship into the index. */
+	void RemoveShipAt(int32 InShipIndex);
+
+	FFleet* FindFleet(FSGSM_FleetHandle InFleet);
+
+	TSparseArray<FFleet> Fleets;
+
+	TArray<FFleetShip> Ships;
+	TMap<TObjectKey<USGSM_PropulsionBrain>, int32> ShipIndices;
+
+	// Rebuilt every frame.
+	TArray<FShipSample> Samples;
+	TArray<FVector> SampleLocations;
+	TArray<FSGSM_PilotInput> Outputs;
+	FSGSM_SpatialHash SpatialHash;
+
+};
@@ -0,0 +1,73 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+
+/*
+ * Lock-free single-producer/single-consumer channel carrying input snapshots from the game thread to the physics thread.
+ * Snapshots are complete POD copies of the input stamped with the physics frame they target,
+ * so the physics step only needs the latest one that is due and never reads game thread memory.
+ *
+ * SnapshotType must be trivially copyable and expose an int32 TargetFrame.
+ */
+template <typename SnapshotType>
+class TSGSM_InputChannel
+{
+	static_assert(std::is_trivially_copyable_v<SnapshotType>, "Input snapshots must be trivially copyable");
+
+public:
+
+	explicit TSGSM_InputChannel(uint32 InCapacity = 32)
+		: Queue(InCapacity + 1)
+	{
+	}
+
+	/** Game thread. Queues InSnapshot, keeping it aside when the queue is full so the latest input is never lost. */
+	void Push(const SnapshotType& InSnapshot)
+	{
+		Pending = InSnapshot;
+		bHasPending = true;
+		Flush();
+	}
+
+	/** Game thread. Retries a snapshot that did not fit in the queue, returns true when nothing is left pending. */
+	bool Flush()
+	{
+		if (bHasPending && Queue.Enqueue(Pending))
+		{
+			bHasPending = false;
+		}
+		return !bHasPending;
+	}
+
+	bool HasPending() const { return bHasPending; }
+
+	/** Physics thread. Drains every snapshot due at InPhysicsFrame into OutSnapshot, returns false when none was due. */
+	bool ConsumeLatest(int32 InPhysicsFrame, SnapshotType& OutSnapshot)
+	{
+		bool bConsumed = false;
+		while (const SnapshotType* Next = Queue.Peek())
+		{
+			if (Next->TargetFrame > InPhysicsFrame)
+			{
+				break;
+			}
+
+			OutSnapshot = *Next;
+			Queue.Dequeue();
+			bConsumed = true;
+		}
+		return bConsumed;
+	}
+
+private:
+
+	TCircularQueue<SnapshotType> Queue;
+
+	// Producer side only
+	SnapshotType Pending{};
+	bool bHasPending = false;
+
+};
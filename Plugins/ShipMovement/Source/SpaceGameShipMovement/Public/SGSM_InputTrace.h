@@ -0,0 +1,71 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_PilotInput.h"
+
+/*
+ * One change of a ship's pilot input, applied from Frame on.
+ */
+struct FSGSM_InputTraceRecord
+{
+	int32 Frame = 0;
+	int32 Ship = 0;
+	FSGSM_QuantizedPilotInput Input;
+};
+
+/*
+ * Captured pilot input of a session, as frame stamped changes per ship.
+ * Stored as a small header followed by one record per change: packed frame delta, packed ship index, four axis bytes, a boost byte
+ * and a flag byte.
+ */
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_InputTrace
+{
+	static constexpr uint32 Magic = 0x54494753; // "SGIT"
+	static constexpr uint16 Version = 1;
+
+	// Debug name of every recorded ship, indexed by FSGSM_InputTraceRecord::Ship.
+	TArray<FString> ShipNames;
+
+	// Sorted by frame.
+	TArray<FSGSM_InputTraceRecord> Records;
+
+	int32 NumFrames = 0;
+	float AverageDeltaTime = 1.f / 60.f;
+
+	int32 GetNumShips() const { return ShipNames.Num(); }
+
+	void Serialize(FArchive& Ar);
+
+	bool SaveToFile(const FString& InFilename);
+	bool LoadFromFile(const FString& InFilename);
+};
+
+/*
+ * Plays a trace back onto any number of ships. Playback ship N follows recorded ship N, ships past the recorded count stay idle.
+ */
+class SPACEGAMESHIPMOVEMENT_API FSGSM_InputTracePlayer
+{
+public:
+
+	void Reset(const FSGSM_InputTrace* InTrace, int32 InNumShips);
+
+	/** Applies every record up to InFrame, wrapping around once the end of the trace is reached when looping. */
+	void Advance(int32 InFrame, bool bInLoop);
+
+	/** Current input of a playback ship, idle input for ships the trace does not have. */
+	FSGSM_PilotInput GetInput(int32 InShip) const;
+
+	bool IsFinished() const;
+
+private:
+
+	const FSGSM_InputTrace* Trace = nullptr;
+
+	TArray<FSGSM_PilotInput> RecordedInputs;
+	int32 NumShips = 0;
+	int32 NextRecord = 0;
+	int32 LoopStartFrame = 0;
+	int32 CurrentFrame = 0;
+};
@@ -0,0 +1,103 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SGSM_InputTrace.h"
+#include "SGSM_InputTraceSubsystem.generated.h"
+
+class USGSM_PropulsionBrain;
+
+/*
+ * Captures the pilot input of every ship in a world to a trace file and plays traces back for profiling sessions.
+ * Recording samples brains that received input during the frame once all actors ticked and stores only changes.
+ * Replay applies the trace at the start of every frame, so a session can be re-run with identical input.
+ * See sgsm.Trace.Record, sgsm.Trace.Stop and sgsm.Trace.Replay.
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_InputTraceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static USGSM_InputTraceSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts recording every brain in the world, including ones spawned later. */
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	void StartRecording();
+
+	/** Stops recording and writes the trace, defaults to Saved/InputTraces when InFilename is empty. */
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	bool StopRecording(const FString& InFilename);
+
+	/*
+	 * Replays a trace onto the brains currently in the world, each recorded ship onto the ship with the same owner name.
+	 * Recorded ships whose name is gone fall back to the remaining ships in name order, ships left without a recorded ship stay idle.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	bool StartReplay(const FString& InFilename, bool bInLoop = false);
+
+	/** Replays onto the given brains only, the brain at index N follows recorded ship N. Null entries leave a recorded ship unplayed. */
+	void StartReplayTrace(const FSGSM_InputTrace& InTrace, TArray<USGSM_PropulsionBrain*> InBrains, bool bInLoop = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	void StopReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	bool IsRecording() const { return bRecording; }
+
+	UFUNCTION(BlueprintCallable, Category = "Input Trace")
+	bool IsReplaying() const { return bReplaying; }
+
+	static FString GetDefaultTraceDirectory();
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void BindBrain(USGSM_PropulsionBrain* InBrain);
+	void UnbindBrains();
+
+	void OnActorSpawned(AActor* InActor);
+	void OnPilotInputIssued(USGSM_PropulsionBrain* InBrain);
+
+	/** Stores the input of every brain that received input this frame, if it changed. */
+	void SampleDirtyBrains();
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick InTickType, float InDeltaTime);
+
+	struct FRecordedBrain
+	{
+		TWeakObjectPtr<USGSM_PropulsionBrain> Brain;
+		FSGSM_QuantizedPilotInput LastInput;
+		int32 Ship = INDEX_NONE;
+		bool bDirty = false;
+	};
+
+	FSGSM_InputTrace Trace;
+
+	TArray<FRecordedBrain> RecordedBrains;
+	TMap<TObjectKey<USGSM_PropulsionBrain>, int32> RecordedBrainIndices;
+
+	FDelegateHandle ActorSpawnedHandle;
+	double RecordedSeconds = 0.0;
+	int32 Frame = 0;
+	bool bRecording = false;
+
+	FSGSM_InputTrace ReplayTrace;
+	FSGSM_InputTracePlayer Player;
+	TArray<TWeakObjectPtr<USGSM_PropulsionBrain>> ReplayBrains;
+	FDelegateHandle WorldTickStartHandle;
+	bool bReplaying = false;
+	bool bLoopReplay = false;
+
+};
@@ -0,0 +1,52 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_PropulsionState.h"
+
+struct FSGSM_PilotInput;
+struct FSGSM_RocketLayout;
+
+/*
+ * Simplified propulsion model for ships without a Chaos body of their own.
+ * Shared by the far propulsion tier and by Mass ships, so both follow the same thrust envelope, brake and turn limits.
+ */
+namespace SGSM_KinematicPropulsion
+{
+	/** Thruster output of one controller update. */
+	struct FThrusterResult
+	{
+		FVector Force = FVector::ZeroVector;
+		FVector Torque = FVector::ZeroVector;
+
+		FVector LinearThrustVector = FVector::ZeroVector;
+		double CurrentYawTorque = 0.0;
+		bool bLinearThrustActive = false;
+		bool bAngularThrustActive = false;
+	};
+
+	/** Whether rockets apply the torque of their mount offset, see sgsm.Propulsion.RocketMountTorque. */
+	SPACEGAMESHIPMOVEMENT_API bool IsRocketMountTorqueEnabled();
+
+	/** Thrust in centinewtons along InDirection, within the envelope of the specs. */
+	SPACEGAMESHIPMOVEMENT_API FVector GetThrustOutput(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FQuat& InBodyRotation, const FVector& InDirection);
+	SPACEGAMESHIPMOVEMENT_API double GetMaxThrustMagnitude(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FQuat& InBodyRotation, const FVector& InDirection);
+
+	/*
+	 * Steers straight for a target yaw rate and brakes to rest over InHorizon seconds, instead of running the full thruster model.
+	 */
+	SPACEGAMESHIPMOVEMENT_API void TickThrusters(const FSGSM_ThrusterSpecs& InSpecs, const FSGSM_ThrusterInputSnapshot& InInput, const FSGSM_KinematicBody& InBody, double InHorizon, FThrusterResult& OutResult);
+
+	/*
+	 * Boost of a rocket layout, the way USGSM_PropulsionBrain engages its rockets without thrust allocation.
+	 * Returns the average rocket power in [0, 1].
+	 */
+	SPACEGAMESHIPMOVEMENT_API double AccumulateRocketBoost(const FSGSM_RocketLayout& InLayout, const FSGSM_KinematicBody& InBody, const FVector& InDirection, double InScale, FVector& InOutForce, FVector& InOutTorque);
+
+	/** Semi-implicit Euler, the same integration order Chaos uses. */
+	SPACEGAMESHIPMOVEMENT_API void Integrate(FSGSM_KinematicBody& InOutBody, const FVector& InForce, const FVector& InTorque, double DeltaTime);
+
+	/** Thruster input USGSM_PropulsionBrain would push for the given pilot intent. */
+	SPACEGAMESHIPMOVEMENT_API FSGSM_ThrusterInputSnapshot MakeThrusterInput(const FSGSM_PilotInput& InPilotInput, const FQuat& InBodyRotation);
+}
@@ -7,6 +7,8 @@
 SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogBrain, Log, All);
 SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogThruster, Log, All);
 SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogRocket, Log, All);
+SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogPropulsion, Log, All);
+SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogNet, Log, All);
 
 SPACEGAMESHIPMOVEMENT_API DECLARE_LOG_CATEGORY_EXTERN(SMLogUtils, Log, All);
 
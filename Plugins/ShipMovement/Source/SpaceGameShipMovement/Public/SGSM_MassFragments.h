@@ -0,0 +1,122 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_PropulsionState.h"
+#include "SGSM_RocketLayout.h"
+#include "SGSM_MassFragments.generated.h"
+
+class APawn;
+
+/*
+ * Marks entities stepped by USGSM_MassPropulsionProcessor.
+ */
+USTRUCT()
+struct FSGSM_MassShipTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/*
+ * Marks ships that are currently converted to a pawn. Their entity keeps the last state but is not stepped.
+ */
+USTRUCT()
+struct FSGSM_MassShipPawnTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/*
+ * Pawn class a Mass ship was captured from and converts back to, along with the rigid body properties of its root.
+ * Shared by every entity of the class.
+ */
+USTRUCT()
+struct FSGSM_MassShipClassFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<APawn> ShipClass;
+
+	// Unscaled local space.
+	UPROPERTY()
+	FVector CenterOfMass = FVector::ZeroVector;
+
+	UPROPERTY()
+	double Mass = 1.0;
+
+	UPROPERTY()
+	double Inertia = 1.0;
+};
+
+/*
+ * Thruster specifications of a ship class, built by USGSM_ThrustersComponent.
+ * Not reflected, so it has to be registered by hash; USGSM_MassShipSubsystem uses the ship class.
+ */
+USTRUCT()
+struct FSGSM_MassThrusterSpecsFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	FSGSM_ThrusterSpecs Specs;
+};
+
+/*
+ * Rocket mounts of a ship class in ship-local space, as laid out by USGSM_PropulsionBrain.
+ */
+USTRUCT()
+struct FSGSM_MassRocketLayoutFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	FSGSM_RocketLayout Layout;
+};
+
+/*
+ * Pilot intent of a Mass ship, written by AI or traffic logic.
+ */
+USTRUCT()
+struct FSGSM_MassPilotInputFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FSGSM_PilotInput Input;
+};
+
+/*
+ * Velocities of a Mass ship, its location and rotation live in FTransformFragment.
+ */
+USTRUCT()
+struct FSGSM_MassShipBodyFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	// Radians per second.
+	UPROPERTY()
+	FVector AngularVelocity = FVector::ZeroVector;
+};
+
+/*
+ * Propulsion output of the last step, for visuals and for the pawn a ship converts to.
+ */
+USTRUCT()
+struct FSGSM_MassPropulsionOutputFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector LinearThrustVector = FVector::ZeroVector;
+
+	UPROPERTY()
+	double CurrentYawTorque = 0.0;
+
+	UPROPERTY()
+	float AverageRocketPower = 0.f;
+};
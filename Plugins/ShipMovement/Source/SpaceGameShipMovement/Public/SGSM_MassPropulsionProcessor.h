@@ -0,0 +1,31 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "SGSM_MassPropulsionProcessor.generated.h"
+
+/*
+ * Steps every Mass ship with the kinematic propulsion model of the far tier, in parallel chunks.
+ * Thrust, brake and turn limits come from the thruster specs and rocket layout shared by the ship class.
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_MassPropulsionProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	USGSM_MassPropulsionProcessor();
+
+protected:
+
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+
+	FMassEntityQuery EntityQuery;
+
+};
@@ -0,0 +1,95 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassEntityQuery.h"
+#include "MassArchetypeTypes.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_MassShipSubsystem.generated.h"
+
+class APawn;
+struct FMassEntityManager;
+
+/*
+ * Runs background and NPC ships as Mass entities instead of pawns.
+ * A ship class is captured once from a template pawn, after which any number of entities of that class share its thruster
+ * specs and rocket layout. Entities near a player are converted to full pawns and pawns this subsystem converted are turned back
+ * into entities once every player is far away again, see sgsm.Mass.*
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_MassShipSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static USGSM_MassShipSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Spawns one entity per transform, capturing the ship class first if needed. */
+	bool SpawnShips(TSubclassOf<APawn> InShipClass, TConstArrayView<FTransform> InTransforms, TArray<FMassEntityHandle>& OutEntities);
+
+	FMassEntityHandle SpawnShip(TSubclassOf<APawn> InShipClass, const FTransform& InTransform, const FVector& InLinearVelocity = FVector::ZeroVector);
+
+	void DestroyShip(FMassEntityHandle InEntity);
+
+	/** Sets the pilot intent of a ship, whether it currently is an entity or was converted to a pawn. */
+	void SetShipInput(FMassEntityHandle InEntity, const FSGSM_PilotInput& InPilotInput);
+
+	/** Pawn the ship is currently converted to, nullptr while it runs as an entity. */
+	APawn* GetShipPawn(FMassEntityHandle InEntity) const;
+
+	/** Converts any ship pawn to an entity, destroying the pawn. Pawns possessed by a player are refused. */
+	FMassEntityHandle ConvertToEntity(APawn* InPawn);
+
+	/** Converts an entity to a full pawn. The entity is kept, without being stepped, so its handle stays valid. */
+	APawn* ConvertToPawn(FMassEntityHandle InEntity);
+
+	UFUNCTION(BlueprintCallable, Category = "Mass Ship Subsystem")
+	int32 GetNumEntityShips() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Mass Ship Subsystem")
+	int32 GetNumPawnShips() const { return ConvertedPawns.Num(); }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FShipClassData
+	{
+		FMassArchetypeSharedFragmentValues SharedValues;
+	};
+
+	/** Spawns a template pawn of the class and captures its thruster specs, rocket layout and body. */
+	const FShipClassData* FindOrCaptureShipClass(TSubclassOf<APawn> InShipClass);
+
+	FMassEntityManager* GetEntityManager() const;
+
+	/** Moves ships between entity and pawn by their distance to the nearest player, a bounded number per frame. */
+	void UpdateConversions();
+
+	static FTransform GetPawnBodyState(const APawn* InPawn, FVector& OutLinearVelocity, FVector& OutAngularVelocity);
+
+	TMap<TSubclassOf<APawn>, FShipClassData> ShipClasses;
+
+	FMassArchetypeHandle ShipArchetype;
+
+	/** Copies the state of a converted pawn back into its entity and resumes stepping it. */
+	void ReturnToEntity(FMassEntityHandle InEntity, APawn* InPawn);
+
+	TMap<FMassEntityHandle, TWeakObjectPtr<APawn>> ConvertedPawns;
+
+	// Entities that are stepped by Mass, mutable for counting from const getters.
+	mutable FMassEntityQuery ConversionQuery;
+
+};
@@ -0,0 +1,47 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NiagaraDataInterface.h"
+#include "SGSM_NiagaraDataInterfacePropulsion.generated.h"
+
+class USGSM_PropulsionBrain;
+
+/*
+ * Exposes the thruster and rocket output of the ship a Niagara system is attached to, so exhaust effects read it directly
+ * instead of having it pushed as user parameters every frame.
+ * The ship is the attachment root of the owner of the Niagara component. Its output is sampled once per frame on the game thread
+ * and served to the simulation from that copy, CPU simulation only.
+ */
+UCLASS(EditInlineNew, Category = "Ship Movement", CollapseCategories, Meta = (DisplayName = "Ship Propulsion"))
+class SPACEGAMESHIPMOVEMENT_API USGSM_NiagaraDataInterfacePropulsion : public UNiagaraDataInterface
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void PostInitProperties() override;
+
+	virtual void GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc) override;
+	virtual bool CanExecuteOnTarget(ENiagaraSimTarget Target) const override { return Target == ENiagaraSimTarget::CPUSim; }
+
+	virtual int32 PerInstanceDataSize() const override;
+	virtual bool InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual void DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual bool PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds) override;
+	virtual bool HasPreSimulateTick() const override { return true; }
+
+protected:
+
+#if WITH_EDITORONLY_DATA
+	virtual void GetFunctionsInternal(TArray<FNiagaraFunctionSignature>& OutFunctions) const override;
+#endif
+
+private:
+
+	void VMGetShipThrust(FVectorVMExternalFunctionContext& Context);
+	void VMGetNumRockets(FVectorVMExternalFunctionContext& Context);
+	void VMGetRocketThrust(FVectorVMExternalFunctionContext& Context);
+	void VMGetRocketMount(FVectorVMExternalFunctionContext& Context);
+};
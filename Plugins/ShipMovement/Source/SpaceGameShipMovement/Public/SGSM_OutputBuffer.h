@@ -0,0 +1,38 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/TripleBuffer.h"
+
+/*
+ * Wait-free channel publishing one output record per physics step to game thread readers.
+ * The physics thread writes a complete record and swaps it in, the game thread always reads the most recent complete record,
+ * neither side ever blocks or sees a torn record.
+ */
+template <typename RecordType>
+class TSGSM_OutputBuffer
+{
+public:
+
+	/** Physics thread. */
+	void Publish(const RecordType& InRecord)
+	{
+		Buffer.WriteAndSwap(InRecord);
+	}
+
+	/** Game thread. */
+	const RecordType& ReadLatest() const
+	{
+		if (Buffer.IsDirty())
+		{
+			Buffer.SwapReadBuffers();
+		}
+		return Buffer.Read();
+	}
+
+private:
+
+	mutable TTripleBuffer<RecordType> Buffer;
+
+};
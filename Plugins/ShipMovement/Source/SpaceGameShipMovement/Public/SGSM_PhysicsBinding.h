@@ -0,0 +1,37 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+class UPrimitiveComponent;
+
+/*
+ * Binds a ship to the physics proxy of its simulated body.
+ * The proxy is captured on the game thread whenever the body's physics state is created, and cleared when it is destroyed,
+ * so the physics thread resolves the rigid body handle once per step without walking the component and body instance.
+ */
+class SPACEGAMESHIPMOVEMENT_API FSGSM_PhysicsBinding
+{
+public:
+
+	/** Game thread. Captures the current physics proxy of InBody, or clears the binding when it has none. */
+	void Bind(const UPrimitiveComponent* InBody);
+	void Invalidate();
+
+	/** Physics thread. Returns the rigid body handle, or nullptr (with a rate-limited warning) when the body is missing. */
+	Chaos::FRigidBodyHandle_Internal* Resolve();
+
+	bool IsBound() const { return Proxy != nullptr; }
+
+private:
+
+	FPhysicsActorHandle Proxy = nullptr;
+	FName DebugName;
+
+	double LastMissingBodyLogTime = -UE_BIG_NUMBER;
+
+	static constexpr double MissingBodyLogInterval = 5.0;
+
+};
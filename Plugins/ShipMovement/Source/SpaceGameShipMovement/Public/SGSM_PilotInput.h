@@ -0,0 +1,82 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_PilotInput.generated.h"
+
+/*
+ * Complete pilot intent for a ship at one point in time, as held by USGSM_PropulsionBrain.
+ * Everything the brain needs to reproduce its propulsion, so it can be sent over the network or recorded.
+ */
+USTRUCT(BlueprintType)
+struct FSGSM_PilotInput
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	FVector2D LinearThrust = FVector2D::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	FVector2D AngularThrust = FVector2D::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	float BoostValue = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	bool bBoosting = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	bool bLinearBrake = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	bool bAngularBrake = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pilot Input")
+	bool bAlternativeTurning = false;
+};
+
+/*
+ * FSGSM_PilotInput quantized for the wire: four signed byte axes, one byte of boost and four flag bits.
+ * Sequence orders packets so stale unreliable ones can be dropped.
+ */
+USTRUCT()
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_QuantizedPilotInput
+{
+	GENERATED_BODY()
+
+	int8 LinearX = 0;
+	int8 LinearY = 0;
+	int8 AngularX = 0;
+	int8 AngularY = 0;
+	uint8 Boost = 0;
+	uint8 Flags = 0;
+
+	uint16 Sequence = 0;
+
+	enum EFlags : uint8
+	{
+		Boosting = 1 << 0,
+		LinearBrake = 1 << 1,
+		AngularBrake = 1 << 2,
+		AlternativeTurning = 1 << 3,
+		NumFlagBits = 4
+	};
+
+	static FSGSM_QuantizedPilotInput Quantize(const FSGSM_PilotInput& InInput);
+	FSGSM_PilotInput Dequantize() const;
+
+	/** Same pilot intent, ignoring the sequence. */
+	bool HasSameInput(const FSGSM_QuantizedPilotInput& Other) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSGSM_QuantizedPilotInput> : public TStructOpsTypeTraitsBase2<FSGSM_QuantizedPilotInput>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
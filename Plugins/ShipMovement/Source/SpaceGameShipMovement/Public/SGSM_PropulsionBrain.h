@@ -5,11 +5,24 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "SGSM_Utils.h"
+#include "SGSM_RocketLayout.h"
+#include "SGSM_ThrustAllocator.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_ShipClassDefinition.h"
+#include "SGSM_PropulsionStatus.h"
 #include "SGSM_PropulsionBrain.generated.h"
 
 class USGSM_RocketComponent;
+class USGSM_PropulsionSubsystem;
+struct FSGSM_ShipAssembly;
 class USGSM_ThrustersComponent;
 class UStaticMeshComponent;
+class USGSM_PropulsionBrain;
+struct FStreamableHandle;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FSGSM_OnPilotInputIssued, USGSM_PropulsionBrain*);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FSGSM_OnPropulsionStatusChanged, USGSM_PropulsionBrain*, const FSGSM_PropulsionStatus&);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FSGSM_OnPropulsionStatusChangedDynamic, USGSM_PropulsionBrain*, Brain, const FSGSM_PropulsionStatus&, Status);
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class SPACEGAMESHIPMOVEMENT_API USGSM_PropulsionBrain : public UActorComponent
@@ -23,6 +36,7 @@ public:
 protected:
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 
@@ -38,6 +52,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain - Rockets")
 	void RemoveRocketComponent(USGSM_RocketComponent* const InRocketComponent);
 
+	/** Called by the ship assembly as rockets attach to or detach from this ship. */
+	void OnAssemblyRocketJoined(USGSM_RocketComponent* InRocketComponent);
+	void OnAssemblyRocketLeft(USGSM_RocketComponent* InRocketComponent);
+
 	/**
 	 * Returns a value between 0 and 1 representing the total rocket power being used.
 	 * This can be useful when controlling a rocket sound effect that represents all rockets at once.
@@ -57,12 +75,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain - Thrusters")
 	FVector GetCurrentLinearThrustNormal() const;
 
+	/*
+	 * Broadcast at the start of every pilot input call below, so recorders can mark the brain and sample GetPilotInput later in the frame.
+	 * Tick calls broadcast every frame they are issued, not only when the input changes.
+	 */
+	FSGSM_OnPilotInputIssued OnPilotInputIssued;
+
 	void TickLinearThrust(const FVector& InValue);
 	void EndLinearThrust();
 
 	void TickAngularThrust(const FVector& InValue);
 	void EndAngularThrust();
 
+	/** Drives every rocket so their combined output best matches a world space force and yaw torque. */
+	void AllocateRocketThrust(const FVector& InForce, double InYawTorque);
+
 	void TickBoosting(const float& InValue);
 	void EndBoosting();
 	bool IsBoosting() const;
@@ -79,22 +106,88 @@ public:
 	void SetAlternativeTurning(bool IsEnabled);
 	bool IsAlternativeTurning() const;
 
+	/** Current pilot intent, everything needed to reproduce this brain's propulsion elsewhere. */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain")
+	FSGSM_PilotInput GetPilotInput() const;
+
+	/** Drives the brain to the given pilot intent, issuing only the calls whose state differs. */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain")
+	void ApplyPilotInput(const FSGSM_PilotInput& InPilotInput);
+
+	/** Rocket mounts of this ship in ship-local space. */
+	const FSGSM_RocketLayout& GetRocketLayout() const { return RocketLayout; }
+
 	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain - Thrusters")
 	void SetThrustersSpecifications(const FThrustersSpecifications& InThrustersSpecifications);
 
 	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain - Rockets")
 	void SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications);
 
+	/** Switches this ship to a loaded ship class keeping its overrides, or back to its own specifications when null. */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain")
+	void SetShipClass(USGSM_ShipClassDefinition* InShipClass);
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain")
+	void SetShipClassOverrides(const FSGSM_ShipClassOverrides& InShipClassOverrides);
+
+	/*
+	 * Broadcast on the game thread when the propulsion status moved past StatusThresholds, at most once per frame.
+	 * Only while status broadcasting is enabled, the status Changes tell what moved.
+	 */
+	FSGSM_OnPropulsionStatusChanged OnPropulsionStatusChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Propulsion Brain - Status", Meta = (DisplayName = "On Propulsion Status Changed"))
+	FSGSM_OnPropulsionStatusChangedDynamic BP_OnPropulsionStatusChanged;
+
+	/** Status as of the last broadcast, cheaper than polling the individual getters. */
+	UFUNCTION(BlueprintPure, Category = "Propulsion Brain - Status")
+	const FSGSM_PropulsionStatus& GetPropulsionStatus() const { return PropulsionStatus; }
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Brain - Status")
+	void SetBroadcastStatus(bool bInBroadcastStatus);
+
+	/** Called once per frame by the propulsion subsystem while status broadcasting is enabled. */
+	void UpdatePropulsionStatus();
+
+	const TSoftObjectPtr<USGSM_ShipClassDefinition>& GetShipClass() const { return ShipClass; }
+
+	/** Whether the ship class is still loading, the ship has no thrust until it arrives. */
+	bool IsShipClassLoading() const { return ShipClassLoadHandle.IsValid(); }
+
+	/** Class data in use by this ship, overrides applied. */
+	const FSGSM_ShipClassData& GetShipClassData() const { return ShipClassData ? *ShipClassData : FSGSM_ShipClassData::Empty; }
+
 protected:
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Propulsion Brain", Meta = (ToolTip = "Shared specifications of this ship, loaded asynchronously on begin play. The specifications below are only used when no class is set."))
+	TSoftObjectPtr<USGSM_ShipClassDefinition> ShipClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Propulsion Brain", Meta = (ToolTip = "Per-ship changes on top of the ship class, a ship without overrides shares the class data."))
+	FSGSM_ShipClassOverrides ShipClassOverrides;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Brain - Thrusters")
 	FThrustersSpecifications ThrusterSpecs;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Brain - Rockets")
 	FRocketSpecifications RocketSpecs;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Propulsion Brain - Status", Meta = (ToolTip = "Broadcast OnPropulsionStatusChanged for audio, effects and HUD instead of having them poll the brain every frame."))
+	bool bBroadcastStatus = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Brain - Status")
+	FSGSM_PropulsionStatusThresholds StatusThresholds;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Brain - Rockets", Meta = (ToolTip = "Solve rocket throttles for the whole layout when boosting instead of engaging each rocket by its own heading. Changes how existing ships boost, so it is opt-in."))
+	bool bUseThrustAllocation = false;
+
 	static double CalculateRocketEngagementValue(const USGSM_RocketComponent* InThruster, const FVector& InDirection);
 
+	/** Recaptures the ship-local layout of all rockets, only needed when every rocket is set up again. Joining, leaving and re-attached rockets update their own entry. */
+	void RebuildRocketLayout();
+
+	/** A rocket was re-attached or its efficiency changed, updates only its layout entry and allocator column. */
+	void OnRocketLayoutChanged(USGSM_RocketComponent* InRocketComponent);
+
 	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Brain")
 	APawn* OwnerPawn = nullptr;
 
@@ -103,5 +196,34 @@ protected:
 
 	FVector LinearThrustDirection = FVector::ZeroVector;
 	FVector AngularThrustDirection = FVector::ZeroVector;
+	float BoostValue = 0.f;
+
+	UPROPERTY(Transient)
+	USGSM_PropulsionSubsystem* PropulsionSubsystem = nullptr;
+
+	FSGSM_ShipAssembly* Assembly = nullptr;
+
+	FSGSM_RocketLayout RocketLayout;
+	FSGSM_ThrustAllocator ThrustAllocator;
+	TArray<double> RocketActivations;
+
+	/** Pushes RocketActivations as throttles to the rockets of RocketLayout. */
+	void ApplyRocketActivations(const FQuat& InShipRotation, double InScale);
+
+	/** Uses the data of ShipClass right away when it is loaded, otherwise once its async load completes. */
+	void LoadShipClass();
+	void OnShipClassLoaded();
+
+	/** Applies the overrides on top of InClassData and hands the result to the thrusters and rockets. */
+	void SetBaseShipClassData(const TSharedRef<const FSGSM_ShipClassData>& InClassData);
+
+	// Class data before and after the overrides, the same pointer when nothing is overridden.
+	TSharedPtr<const FSGSM_ShipClassData> BaseShipClassData;
+	TSharedPtr<const FSGSM_ShipClassData> ShipClassData;
+
+	TSharedPtr<FStreamableHandle> ShipClassLoadHandle;
+
+	FSGSM_PropulsionStatus PropulsionStatus;
+	bool bHasBroadcastStatus = false;
 
 };
@@ -0,0 +1,359 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/*
+ * Engine-independent propulsion math.
+ * Plain functions over plain vector and quaternion types, shared by the plugin and the standalone benchmark and test target in
+ * Plugins/ShipMovement/Tools/PropulsionMath, so the kernels can be measured and changed without an editor build.
+ * Only the C++ standard library may be included here.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+namespace SGSM_PropulsionMath
+{
+	constexpr double CentinewtonsPerNewton = 100.0;
+	constexpr double CentinewtonsPerKiloNewton = 100000.0;
+	constexpr double CentinewtonsPerMegaNewton = 100000000.0;
+
+	constexpr double NearlyZeroTolerance = 1.e-4;
+	constexpr double SmallNumber = 1.e-8;
+	constexpr double Pi = 3.1415926535897932384626433832795;
+
+	struct FVec3
+	{
+		double X = 0.0;
+		double Y = 0.0;
+		double Z = 0.0;
+	};
+
+	struct FQuat4
+	{
+		double X = 0.0;
+		double Y = 0.0;
+		double Z = 0.0;
+		double W = 1.0;
+	};
+
+	inline FVec3 operator+(const FVec3& A, const FVec3& B) { return { A.X + B.X, A.Y + B.Y, A.Z + B.Z }; }
+	inline FVec3 operator-(const FVec3& A, const FVec3& B) { return { A.X - B.X, A.Y - B.Y, A.Z - B.Z }; }
+	inline FVec3 operator-(const FVec3& A) { return { -A.X, -A.Y, -A.Z }; }
+	inline FVec3 operator*(const FVec3& A, double S) { return { A.X * S, A.Y * S, A.Z * S }; }
+	inline FVec3 operator*(const FVec3& A, const FVec3& B) { return { A.X * B.X, A.Y * B.Y, A.Z * B.Z }; }
+
+	inline double Dot(const FVec3& A, const FVec3& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+	inline FVec3 Cross(const FVec3& A, const FVec3& B) { return { A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X }; }
+	inline double Length(const FVec3& A) { return std::sqrt(Dot(A, A)); }
+	inline double Length2D(const FVec3& A) { return std::sqrt(A.X * A.X + A.Y * A.Y); }
+
+	inline double Sign(double A) { return A > 0.0 ? 1.0 : A < 0.0 ? -1.0 : 0.0; }
+	inline FVec3 Sign(const FVec3& A) { return { Sign(A.X), Sign(A.Y), Sign(A.Z) }; }
+
+	inline bool IsNearlyZero(const FVec3& A, double Tolerance = NearlyZeroTolerance)
+	{
+		return std::abs(A.X) <= Tolerance && std::abs(A.Y) <= Tolerance && std::abs(A.Z) <= Tolerance;
+	}
+
+	/** Normal of the XY part, zero when it is too short to normalize. */
+	inline FVec3 SafeNormal2D(const FVec3& A)
+	{
+		const double SquareSum = A.X * A.X + A.Y * A.Y;
+		if (SquareSum < SmallNumber)
+		{
+			return {};
+		}
+		const double Scale = 1.0 / std::sqrt(SquareSum);
+		return { A.X * Scale, A.Y * Scale, 0.0 };
+	}
+
+	inline FVec3 RotateVector(const FQuat4& Q, const FVec3& V)
+	{
+		// V' = V + 2w(Q x V) + (2Q x (Q x V))
+		const FVec3 Axis{ Q.X, Q.Y, Q.Z };
+		const FVec3 T = Cross(Axis, V) * 2.0;
+		return V + T * Q.W + Cross(Axis, T);
+	}
+
+	inline FVec3 UnrotateVector(const FQuat4& Q, const FVec3& V)
+	{
+		return RotateVector(FQuat4{ -Q.X, -Q.Y, -Q.Z, Q.W }, V);
+	}
+
+	inline FVec3 GetForwardVector(const FQuat4& Q)
+	{
+		return RotateVector(Q, FVec3{ 1.0, 0.0, 0.0 });
+	}
+
+	/*
+	 * Directional thrust multipliers of a ship, in ship-local space. A disabled table produces no thrust at all.
+	 */
+	struct FDirectionScale
+	{
+		double Front = 1.0;
+		double Back = 1.0;
+		double Left = 1.0;
+		double Right = 1.0;
+		bool bEnabled = false;
+	};
+
+	/** Per-axis multiplier for a ship-local direction, Z is never scaled. Zero when disabled. */
+	inline FVec3 GetLocalAxisScale(const FDirectionScale& Scale, const FVec3& LocalDirection)
+	{
+		if (!Scale.bEnabled)
+		{
+			return {};
+		}
+
+		const double ScaleX = LocalDirection.X < 0 ? Scale.Front : LocalDirection.X > 0 ? Scale.Back : 1.0;
+		const double ScaleY = LocalDirection.Y < 0 ? Scale.Right : LocalDirection.Y > 0 ? Scale.Left : 1.0;
+
+		return { ScaleX, ScaleY, 1.0 };
+	}
+
+	/*
+	 * Thrust plus boost engagement of a body along a world direction, unscaled by the max thrust.
+	 * Rotates into local space once, applies both multiplier tables per axis and rotates back.
+	 */
+	inline FVec3 GetThrustEngagement(const FQuat4& BodyRotation, const FVec3& Direction, const FDirectionScale& ThrustScale, const FDirectionScale& BoostScale, double BoostAmount)
+	{
+		const FVec3 LocalDirection = UnrotateVector(BodyRotation, Direction);
+		const FVec3 AxisScale = GetLocalAxisScale(ThrustScale, LocalDirection) + GetLocalAxisScale(BoostScale, LocalDirection) * BoostAmount;
+		return RotateVector(BodyRotation, LocalDirection * AxisScale);
+	}
+
+	/*
+	 * Max force in centinewtons along each local +-X/+-Y/+-Z axis, with and without boost.
+	 */
+	struct FThrustEnvelope
+	{
+		enum EAxis : unsigned char
+		{
+			PosX,
+			NegX,
+			PosY,
+			NegY,
+			PosZ,
+			NegZ,
+			NumAxes
+		};
+
+		double BaseForce[NumAxes] = {};
+		double BoostForce[NumAxes] = {};
+
+		static FVec3 GetAxisDirection(EAxis Axis)
+		{
+			switch (Axis)
+			{
+			case PosX: return { 1.0, 0.0, 0.0 };
+			case NegX: return { -1.0, 0.0, 0.0 };
+			case PosY: return { 0.0, 1.0, 0.0 };
+			case NegY: return { 0.0, -1.0, 0.0 };
+			case PosZ: return { 0.0, 0.0, 1.0 };
+			case NegZ: return { 0.0, 0.0, -1.0 };
+			default: return {};
+			}
+		}
+
+		static FThrustEnvelope Build(double MaxLinearCentinewtons, const FDirectionScale& ThrustScale, const FDirectionScale& BoostScale)
+		{
+			FThrustEnvelope Result;
+			for (int Axis = 0; Axis < NumAxes; ++Axis)
+			{
+				const FVec3 AxisDirection = GetAxisDirection(static_cast<EAxis>(Axis));
+				const FVec3 AbsDirection{ std::abs(AxisDirection.X), std::abs(AxisDirection.Y), std::abs(AxisDirection.Z) };
+				Result.BaseForce[Axis] = Dot(GetLocalAxisScale(ThrustScale, AxisDirection), AbsDirection) * MaxLinearCentinewtons;
+				Result.BoostForce[Axis] = Dot(GetLocalAxisScale(BoostScale, AxisDirection), AbsDirection) * MaxLinearCentinewtons;
+			}
+			return Result;
+		}
+
+		double GetMaxForce(EAxis Axis, double BoostAmount) const
+		{
+			return BaseForce[Axis] + BoostForce[Axis] * BoostAmount;
+		}
+
+		FVec3 GetForce(const FVec3& LocalDirection, double BoostAmount) const
+		{
+			return {
+				LocalDirection.X * GetMaxForce(LocalDirection.X < 0 ? NegX : PosX, BoostAmount),
+				LocalDirection.Y * GetMaxForce(LocalDirection.Y < 0 ? NegY : PosY, BoostAmount),
+				LocalDirection.Z * GetMaxForce(LocalDirection.Z < 0 ? NegZ : PosZ, BoostAmount) };
+		}
+	};
+
+	/** Magnitude of the max force the envelope gives along the signs of a world direction. */
+	inline double GetMaxThrustMagnitude(const FThrustEnvelope& Envelope, const FQuat4& BodyRotation, const FVec3& Direction, double BoostAmount)
+	{
+		// Rotating back to world space would not change the length.
+		return Length(Envelope.GetForce(UnrotateVector(BodyRotation, Sign(Direction)), BoostAmount));
+	}
+
+	/*
+	 * Force bringing a body to rest in the XY plane, capped by what the envelope can push against the velocity.
+	 * Zero for a body that is already at rest.
+	 */
+	inline FVec3 GetLinearBrakeForce(const FThrustEnvelope& Envelope, const FQuat4& BodyRotation, const FVec3& LinearVelocity, double BoostAmount)
+	{
+		const FVec3 BrakeDirection = -SafeNormal2D(LinearVelocity);
+
+		const double MaxForceMagnitude = GetMaxThrustMagnitude(Envelope, BodyRotation, BrakeDirection, BoostAmount);
+		const double StoppingForce = Length(LinearVelocity) * 10.0 * CentinewtonsPerKiloNewton;
+
+		return BrakeDirection * std::min(StoppingForce, MaxForceMagnitude);
+	}
+
+	/*
+	 * Yaw torque for a turn input in [-1, 1], reduced so the yaw rate does not pass MaxRateRad by the end of the step.
+	 * Returns false when the body already spins faster than the max rate and no torque should be applied.
+	 */
+	inline bool GetClampedYawTorque(double Input, double MaxTorque, double MaxRateRad, double Inertia, double YawRate, double DeltaTime, double& OutTorque)
+	{
+		const double Torque = MaxTorque * Input;
+		const double ExpectedAcceleration = (Torque / Inertia) * DeltaTime;
+
+		OutTorque = Torque;
+
+		if (std::abs(YawRate + ExpectedAcceleration) > MaxRateRad && ExpectedAcceleration != 0.0)
+		{
+			// Reduce torque with the needed amount to not go higher than the max rate.
+			const double ExcessVelocity = std::abs(YawRate + ExpectedAcceleration) - MaxRateRad;
+			const double ExcessTorque = ExcessVelocity / ExpectedAcceleration;
+			OutTorque += ExcessTorque * Torque * Sign(-Input);
+		}
+
+		return std::abs(YawRate) - MaxRateRad <= 0.0001;
+	}
+
+	/*
+	 * Result of one step of the screen-relative steering controller.
+	 */
+	struct FSteeringCommand
+	{
+		double Torque = 0.0;
+
+		// Torque should be applied this step.
+		bool bApplyTorque = false;
+
+		// Residual spin is too small to brake with torque, the angular velocity should be zeroed instead.
+		bool bStopRotation = false;
+
+		// The controller is actively turning toward the target, not just settling on it.
+		bool bTurning = false;
+	};
+
+	/*
+	 * Steers the body forward toward a target direction in the XY plane.
+	 * Accelerates toward the target while the braking distance allows it, brakes early enough to stop on it within MissToleranceRad
+	 * and corrects for overshoot by turning the short way around.
+	 */
+	inline FSteeringCommand GetScreenRelativeSteering(const FVec3& Forward, const FVec3& TargetDirection, double YawRate, double MaxTorque, double Inertia, double MissToleranceRad, double DeltaTime)
+	{
+		FSteeringCommand Command;
+
+		if (IsNearlyZero(TargetDirection))
+		{
+			return Command;
+		}
+
+		const double MaxTickAcceleration = (MaxTorque / Inertia) * DeltaTime;
+
+		constexpr double Tolerance = 0.001;
+		const bool bAligned = std::abs(Forward.X - TargetDirection.X) <= Tolerance && std::abs(Forward.Y - TargetDirection.Y) <= Tolerance && std::abs(Forward.Z - TargetDirection.Z) <= Tolerance;
+
+		if (bAligned && std::abs(YawRate) <= MaxTickAcceleration)
+		{
+			if (std::abs(YawRate / DeltaTime) > 0)
+			{
+				const double Torque = std::abs(YawRate * Inertia) * CentinewtonsPerNewton;
+
+				if (Torque < (MaxTorque / 1000.0))
+				{
+					Command.bStopRotation = std::abs(YawRate / DeltaTime) > 1.192092896e-07;
+				}
+				else
+				{
+					Command.Torque = std::min(MaxTorque, Torque) * -Sign(YawRate);
+					Command.bApplyTorque = true;
+				}
+			}
+			return Command;
+		}
+
+		const FVec3 CrossProduct = Cross(Forward, TargetDirection);
+		const double Magnitude = Length(CrossProduct);
+		const double DotProduct = Dot(Forward, TargetDirection);
+
+		const double AngleRadians = std::atan2(Magnitude, DotProduct);
+
+		const double MaxAngularAcceleration = MaxTorque / Inertia;
+		const double BreakingDistance = (YawRate * YawRate) / (2 * MaxAngularAcceleration);
+		const double BreakingRevolutions = BreakingDistance / (2.0 * Pi);
+		const double Torque = std::min(MaxTorque, std::abs(Inertia) * std::abs(YawRate + std::abs(AngleRadians)) * CentinewtonsPerNewton);
+
+		double TorqueSign = 0.0;
+
+		if (std::abs(YawRate) <= SmallNumber)
+		{
+			TorqueSign = Sign(CrossProduct.Z);
+		}
+		else if (Sign(YawRate) == Sign(CrossProduct.Z) && BreakingDistance < AngleRadians)
+		{
+			TorqueSign = Sign(CrossProduct.Z);
+		}
+		else if (Sign(YawRate) == Sign(CrossProduct.Z) && BreakingDistance > AngleRadians && std::abs(BreakingDistance - AngleRadians) < MissToleranceRad)
+		{
+			TorqueSign = Sign(-CrossProduct.Z);
+		}
+		else if (Sign(-YawRate) == Sign(CrossProduct.Z))
+		{
+			TorqueSign = Sign(CrossProduct.Z);
+		}
+		else if (BreakingDistance > AngleRadians)
+		{
+			const double MissDistance = ((BreakingRevolutions - std::trunc(BreakingRevolutions)) * 2.0 * Pi) - AngleRadians;
+
+			if (MissDistance < 0)
+			{
+				TorqueSign = Sign(YawRate);
+			}
+			else if (MissDistance > 0 && MissDistance < Pi * 0.5)
+			{
+				TorqueSign = Sign(-YawRate);
+			}
+			else if (MissDistance > 0 && MissDistance > Pi * 0.5)
+			{
+				TorqueSign = Sign(YawRate);
+			}
+			else
+			{
+				return Command;
+			}
+		}
+		else
+		{
+			return Command;
+		}
+
+		Command.Torque = Torque * TorqueSign;
+		Command.bApplyTorque = true;
+		Command.bTurning = true;
+		return Command;
+	}
+
+	/*
+	 * Engagement in [0, 1] of a rocket when thrusting along Direction, projecting the direction onto the segment between the
+	 * rocket's forward and its side facing away from the turn. All vectors in the same space.
+	 */
+	inline double GetRocketEngagement(const FVec3& Direction, const FVec3& Forward, const FVec3& Right)
+	{
+		const double CrossZ = Direction.X * Forward.Y - Direction.Y * Forward.X;
+		const FVec3 R = CrossZ < 0 ? Right : -Right;
+
+		const FVec3 A = Forward - R;
+		const FVec3 C = Direction - R;
+
+		return std::clamp(Dot(C, A) / Dot(A, A), 0.0, 1.0);
+	}
+}
@@ -0,0 +1,88 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SGSM_PilotInput.h"
+#include "SGSM_ShipStateSnapshot.h"
+#include "SGSM_PropulsionNetComponent.generated.h"
+
+class USGSM_PropulsionBrain;
+
+/*
+ * Server-authoritative, client-predicted propulsion for a networked ship.
+ * The owning client quantizes the brain's pilot input and applies the quantized value locally right away, so the local pilot sees no
+ * input latency and predicts exactly what the server will simulate. The same few bytes are sent to the server, which drives its own brain with them.
+ * Ship bodies keep the default physics replication, which blends the owning client toward the server's body on corrections.
+ * Resimulation replication is deliberately not used: the propulsion step drains its input channel every step and keeps no
+ * per-frame input history, so a resim would replay every frame with the latest input and keep diverging.
+ * Everyone else receives a quantized ship state snapshot, delta-compressed against the last one they acknowledged, driving the thrust visuals.
+ */
+UCLASS(ClassGroup=(Custom), Meta=(BlueprintSpawnableComponent))
+class SPACEGAMESHIPMOVEMENT_API USGSM_PropulsionNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	USGSM_PropulsionNetComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Latest replicated ship state, at full precision. Only meaningful on simulated proxies. */
+	const FSGSM_ShipStateSample& GetReplicatedShipState() const { return ReplicatedSample; }
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Net")
+	FVector GetReplicatedLinearThrustNormal() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Net")
+	double GetReplicatedYawTorqueNormalized() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Net")
+	double GetReplicatedAverageRocketPower() const;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION(Server, Unreliable)
+	void ServerSendPilotInput(const FSGSM_QuantizedPilotInput& InPilotInput);
+
+	UFUNCTION()
+	void OnRep_ShipState();
+
+private:
+
+	bool IsLocallyControlled() const;
+
+	/** Server. Samples the body and brain into the replicated ship state. */
+	void UpdateShipState();
+
+	FSGSM_ShipStateSample SampleShipState() const;
+
+	UPROPERTY(EditAnywhere, Category = "Propulsion Net", Meta = (Units = "Seconds", ToolTip = "Unchanged input is re-sent at this interval so a lost unreliable packet is recovered."))
+	float InputResendInterval = 0.1f;
+
+	UPROPERTY(Transient)
+	USGSM_PropulsionBrain* PropulsionBrain = nullptr;
+
+	FSGSM_QuantizedPilotInput LastSentInput;
+	float TimeSinceLastSend = 0.f;
+	bool bHasSentInput = false;
+
+	// Server side, newest input received so far.
+	FSGSM_QuantizedPilotInput ReceivedInput;
+	bool bHasReceivedInput = false;
+
+	UPROPERTY(EditAnywhere, Category = "Propulsion Net", Meta = (ToolTip = "Snap the body of simulated proxies to the replicated ship state. Leave disabled when the body is driven by physics replication."))
+	bool bApplyReplicatedStateToBody = false;
+
+	UPROPERTY(ReplicatedUsing = OnRep_ShipState)
+	FSGSM_ReplicatedShipState ShipState;
+
+	FSGSM_ShipStateSample ReplicatedSample;
+
+};
@@ -0,0 +1,235 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_Utils.h"
+#include "SGSM_PhysicsBinding.h"
+#include "SGSM_InputChannel.h"
+#include "SGSM_OutputBuffer.h"
+
+class UPrimitiveComponent;
+
+/*
+ * Stable handle to a ship (one simulated body) registered with the propulsion subsystem.
+ */
+struct FSGSM_ShipHandle
+{
+	int32 Id = INDEX_NONE;
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+	void Reset() { Id = INDEX_NONE; }
+};
+
+/*
+ * Stable handle to a rocket registered with the propulsion subsystem.
+ */
+struct FSGSM_RocketHandle
+{
+	int32 Id = INDEX_NONE;
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+	void Reset() { Id = INDEX_NONE; }
+};
+
+/*
+ * Simulation tier of a ship, picked from its distance to the nearest player.
+ */
+enum class ESGSM_PropulsionLOD : uint8
+{
+	// Full rigid body thruster model every physics step.
+	Near,
+	// Simplified controller at a reduced rate, its wrench is re-applied in between.
+	Mid,
+	// Body is kinematic and integrated by the propulsion step with the same thrust and turn limits.
+	Far
+};
+
+/*
+ * Motion state of a ship integrated outside of Chaos while in the far tier.
+ */
+struct FSGSM_KinematicBody
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector LinearVelocity = FVector::ZeroVector;
+	// Radians per second.
+	FVector AngularVelocity = FVector::ZeroVector;
+
+	// Unscaled local space, rockets apply their mount torque around it.
+	FVector CenterOfMass = FVector::ZeroVector;
+
+	double Mass = 1.0;
+	double Inertia = 1.0;
+};
+
+/*
+ * Thruster specifications as used by the batched physics step.
+ * Written from the game thread under the registry lock whenever USGSM_ThrustersComponent receives new specifications.
+ */
+struct FSGSM_ThrusterSpecs
+{
+	double MaxLinearCentinewtons = 0.0;
+	double MaxAngularCentinewtons = 0.0;
+	double MaxRotationDegPerSec = 0.0;
+	double MissTolerance = 5.0;
+
+	FSGSM_DirectionMultipliers ThrustMultiplier;
+	FSGSM_DirectionMultipliers BoostMultiplier;
+
+	FSGSM_ThrustEnvelope Envelope;
+};
+
+/*
+ * Complete thruster input of one ship for one physics frame.
+ */
+struct FSGSM_ThrusterInputSnapshot
+{
+	FVector LinearThrustDirection = FVector::ZeroVector;
+	FVector AngularThrustDirection = FVector::ZeroVector;
+	double BoostPercent = 0.0;
+
+	// Physics frame that was running when the input was issued, and the one it applies to.
+	int32 IssuedFrame = 0;
+	int32 TargetFrame = 0;
+
+	bool bLinearBrake = false;
+	bool bAngularBrake = false;
+	bool bAlternativeTurning = false;
+	bool bBoosting = false;
+
+	/** Same input, ignoring the frame stamps. */
+	bool HasSameInput(const FSGSM_ThrusterInputSnapshot& Other) const
+	{
+		return LinearThrustDirection == Other.LinearThrustDirection && AngularThrustDirection == Other.AngularThrustDirection && BoostPercent == Other.BoostPercent
+			&& bLinearBrake == Other.bLinearBrake && bAngularBrake == Other.bAngularBrake && bAlternativeTurning == Other.bAlternativeTurning && bBoosting == Other.bBoosting;
+	}
+};
+
+/*
+ * Complete rocket input for one physics frame.
+ */
+struct FSGSM_RocketInputSnapshot
+{
+	FVector CurrentThrustVector = FVector::ZeroVector;
+
+	// Rocket location in the unscaled local space of the simulated body.
+	FVector MountOffset = FVector::ZeroVector;
+
+	int32 IssuedFrame = 0;
+	int32 TargetFrame = 0;
+
+	bool bRocketThrusting = false;
+};
+
+/*
+ * Propulsion output of one ship for one physics step, published to the game thread.
+ */
+struct FSGSM_ShipOutputSnapshot
+{
+	// Total force and torque applied to the body by thrusters and rockets.
+	FVector AppliedForce = FVector::ZeroVector;
+	FVector AppliedTorque = FVector::ZeroVector;
+
+	// Thrusters only.
+	FVector LinearThrustVector = FVector::ZeroVector;
+	double CurrentYawTorque = 0.0;
+
+	int32 Frame = 0;
+
+	// Far tier only, the transform and velocities the game thread moves the kinematic body to.
+	FSGSM_KinematicBody Kinematic;
+	bool bKinematic = false;
+
+	// Published once as the ship goes dormant, the output then stays unchanged until it wakes.
+	bool bDormant = false;
+
+	bool bLinearThrustActive = false;
+	bool bAngularThrustActive = false;
+	bool bLinearBraking = false;
+	bool bAngularBraking = false;
+};
+
+/*
+ * Output of one rocket for one physics step, published to the game thread.
+ */
+struct FSGSM_RocketOutputSnapshot
+{
+	FVector AppliedThrustVector = FVector::ZeroVector;
+
+	int32 Frame = 0;
+};
+
+/*
+ * Thruster state of a single ship as seen by the batched physics step.
+ * Input only reaches it through InputChannel, everything else is physics thread only.
+ */
+struct FSGSM_ThrusterState
+{
+	FSGSM_ThrusterSpecs Specs;
+
+	// Input, latest snapshot consumed from InputChannel
+	FSGSM_ThrusterInputSnapshot Input;
+	TUniquePtr<TSGSM_InputChannel<FSGSM_ThrusterInputSnapshot>> InputChannel;
+
+	// Working state of the current step
+	FVector LinearThrustVector = FVector::ZeroVector;
+	double CurrentYawTorque = 0.0;
+	bool bLinearThrustActive = false;
+	bool bAngularThrustActive = false;
+};
+
+/*
+ * Rocket state as seen by the batched physics step.
+ */
+struct FSGSM_RocketState
+{
+	// Input, latest snapshot consumed from InputChannel
+	FSGSM_RocketInputSnapshot Input;
+	TUniquePtr<TSGSM_InputChannel<FSGSM_RocketInputSnapshot>> InputChannel;
+
+	// Output
+	FVector AppliedThrustVector = FVector::ZeroVector;
+	TUniquePtr<TSGSM_OutputBuffer<FSGSM_RocketOutputSnapshot>> OutputBuffer;
+
+	int32 Id = INDEX_NONE;
+	int32 ShipId = INDEX_NONE;
+};
+
+/*
+ * Everything the batched physics step needs to know about one simulated body.
+ * Thrusters and any number of rockets attached to the same body share one entry.
+ */
+struct FSGSM_ShipState
+{
+	UPrimitiveComponent* Body = nullptr;
+	FSGSM_PhysicsBinding Binding;
+
+	FSGSM_ThrusterState Thrusters;
+	bool bHasThrusters = false;
+
+	TUniquePtr<TSGSM_OutputBuffer<FSGSM_ShipOutputSnapshot>> OutputBuffer;
+
+	TArray<int32, TInlineAllocator<4>> RocketIds;
+
+	// Written on the game thread under the registry lock.
+	ESGSM_PropulsionLOD LOD = ESGSM_PropulsionLOD::Near;
+
+	// Mid tier, wrench of the last controller update re-applied until the next one or until the thruster input changes.
+	FVector CachedForce = FVector::ZeroVector;
+	FVector CachedTorque = FVector::ZeroVector;
+	int32 NextControllerFrame = 0;
+
+	// Far tier, physics thread only once the ship entered the tier.
+	FSGSM_KinematicBody Kinematic;
+
+	// Physics thread only. Dormant ships are skipped by the step until input or an outside push wakes them.
+	int32 SettledSteps = 0;
+	bool bDormant = false;
+
+	// Game thread only, whether the far tier turned off physics simulation of the body.
+	bool bSimulationSuspendedByLOD = false;
+
+	int32 Id = INDEX_NONE;
+	int32 NumReferences = 0;
+};
@@ -0,0 +1,76 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_PropulsionStatus.generated.h"
+
+/*
+ * Parts of FSGSM_PropulsionStatus that changed since it was last broadcast.
+ */
+UENUM(BlueprintType, Meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ESGSM_PropulsionStatusChange : uint8
+{
+	None = 0 UMETA(Hidden),
+	LinearThrust = 1 << 0,
+	YawTorque = 1 << 1,
+	RocketPower = 1 << 2,
+	Boosting = 1 << 3,
+	Braking = 1 << 4
+};
+ENUM_CLASS_FLAGS(ESGSM_PropulsionStatusChange);
+
+/*
+ * How far a value has to move from its last broadcast before the status is broadcast again.
+ * Values reaching or leaving zero are always broadcast, so effects can start and stop on time.
+ */
+USTRUCT(BlueprintType)
+struct FSGSM_PropulsionStatusThresholds
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Status", Meta = (ClampMin = "0"))
+	float LinearThrust = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Status", Meta = (ClampMin = "0"))
+	float YawTorque = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Propulsion Status", Meta = (ClampMin = "0", ToolTip = "Applies to the average and to each rocket."))
+	float RocketPower = 0.05f;
+};
+
+/*
+ * Cosmetic propulsion state of a ship as last broadcast by USGSM_PropulsionBrain, for audio, effects and HUD.
+ * Thrust and power values are normalized to the max of the ship, RocketPowers follows the order of the brain's rockets.
+ */
+USTRUCT(BlueprintType)
+struct FSGSM_PropulsionStatus
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	FVector LinearThrustNormal = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	float YawTorqueNormalized = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	float AverageRocketPower = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	TArray<float> RocketPowers;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	bool bBoosting = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	bool bLinearBraking = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status")
+	bool bAngularBraking = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Propulsion Status", Meta = (Bitmask, BitmaskEnum = "/Script/SpaceGameShipMovement.ESGSM_PropulsionStatusChange"))
+	int32 Changes = 0;
+
+	bool HasChanged(ESGSM_PropulsionStatusChange InChange) const { return (Changes & static_cast<int32>(InChange)) != 0; }
+};
@@ -0,0 +1,135 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "SGSM_PropulsionState.h"
+#include "SGSM_ShipAssembly.h"
+#include "SGSM_PropulsionSubsystem.generated.h"
+
+class FSGSM_PropulsionSimCallback;
+class USGSM_PropulsionBrain;
+class USGSM_RocketComponent;
+
+/*
+ * Owns the fleet-wide propulsion step of a world.
+ * Thrusters and rocket components register their body here instead of running their own async physics tick,
+ * and every registered ship is then stepped by a single Chaos sim-callback.
+ */
+UCLASS()
+class SPACEGAMESHIPMOVEMENT_API USGSM_PropulsionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static USGSM_PropulsionSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FSGSM_ShipHandle RegisterThrusters(UPrimitiveComponent* InBody);
+	void UnregisterThrusters(FSGSM_ShipHandle& InOutShipHandle);
+
+	FSGSM_RocketHandle RegisterRocket(UPrimitiveComponent* InBody);
+	void UnregisterRocket(FSGSM_RocketHandle& InOutRocketHandle);
+
+	void SetThrusterSpecs(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterSpecs& InSpecs);
+
+	/** Queues input for the next physics step through the ship's lock-free input channel. */
+	void PushThrusterInput(FSGSM_ShipHandle InShipHandle, const FSGSM_ThrusterInputSnapshot& InSnapshot);
+	void PushRocketInput(FSGSM_RocketHandle InRocketHandle, const FSGSM_RocketInputSnapshot& InSnapshot);
+
+	/** Game thread. Most recent complete physics step output, zeroed when the handle is not registered. */
+	FSGSM_ShipOutputSnapshot ReadShipOutput(FSGSM_ShipHandle InShipHandle) const;
+	FSGSM_RocketOutputSnapshot ReadRocketOutput(FSGSM_RocketHandle InRocketHandle) const;
+
+	/** Adds a rocket to the assembly of the ship its owner is currently attached to. */
+	FSGSM_ShipAssembly* JoinAssembly(USGSM_RocketComponent* InRocket);
+	void LeaveAssembly(USGSM_RocketComponent* InRocket, FSGSM_ShipAssembly* InAssembly);
+
+	FSGSM_ShipAssembly* RegisterBrain(USGSM_PropulsionBrain* InBrain);
+	void UnregisterBrain(USGSM_PropulsionBrain* InBrain, FSGSM_ShipAssembly* InAssembly);
+
+	/*
+	 * Call after attaching or detaching a module actor by other means than AttachModule and DetachModule.
+	 * Only the rockets of that module, and of modules attached to it, are moved to their new assembly.
+	 * Rockets re-attached to another component of the same actor move on their own.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Subsystem")
+	void NotifyModuleAttachmentChanged(AActor* InModule);
+
+	/** Attaches a module actor to a ship, or to another module, and moves its rockets to the ship's assembly. */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Subsystem")
+	bool AttachModule(AActor* InModule, USceneComponent* InParent, FName InSocketName = NAME_None);
+
+	/** Detaches a module actor, keeping its world transform, and moves its rockets to the module's own assembly. */
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Subsystem")
+	void DetachModule(AActor* InModule);
+
+	FSGSM_ShipAssembly* FindAssembly(const AActor* InRootActor) const;
+
+	/** Brains registered here update their propulsion status once per frame and broadcast it when it changed. */
+	void RegisterStatusBroadcast(USGSM_PropulsionBrain* InBrain);
+	void UnregisterStatusBroadcast(USGSM_PropulsionBrain* InBrain);
+
+	/** View locations of every local and remote player controller, the points propulsion LOD is measured from. */
+	static void GetPlayerViewpoints(const UWorld* InWorld, TArray<FVector, TInlineAllocator<4>>& OutViewpoints);
+
+	/** Simulation tier the ship currently runs at, see sgsm.Propulsion.LOD.* */
+	ESGSM_PropulsionLOD GetShipLOD(FSGSM_ShipHandle InShipHandle) const;
+
+	/** Whether the ship came to rest without input and is skipped by the propulsion step, see sgsm.Propulsion.Dormancy.* */
+	bool IsShipDormant(FSGSM_ShipHandle InShipHandle) const { return ReadShipOutput(InShipHandle).bDormant; }
+
+	/** Records the duration of every propulsion step until drained, used by the benchmark commandlet. */
+	void SetCaptureStepTimings(bool bInCapture);
+	void DrainStepTimings(TArray<double>& OutSeconds);
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Subsystem")
+	int32 GetNumShips() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Propulsion Subsystem")
+	int32 GetNumRockets() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	FSGSM_PropulsionSimCallback* GetOrCreateSimCallback();
+
+	/** Moves ships between simulation tiers by their distance to the nearest player view point. */
+	void UpdateLOD();
+
+	void UpdatePropulsionStatuses();
+
+	void BindBody(UPrimitiveComponent* InBody);
+	void UnbindBody(UPrimitiveComponent* InBody);
+
+	/** Keeps the physics binding of a ship in sync when its body is recreated or its physics state destroyed. */
+	UFUNCTION()
+	void OnBodyPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+	/** Resolves the component that owns the simulated body, following welding to the parent body. */
+	static UPrimitiveComponent* GetSimulatedBody(UPrimitiveComponent* InBody);
+
+	FSGSM_ShipAssembly& FindOrAddAssembly(AActor* InRootActor);
+	void RemoveAssemblyIfEmpty(FSGSM_ShipAssembly* InAssembly);
+
+	FSGSM_PropulsionSimCallback* SimCallback = nullptr;
+
+	TMap<TObjectKey<AActor>, TUniquePtr<FSGSM_ShipAssembly>> Assemblies;
+
+	// Module actor to the assembly it is part of.
+	TMap<TObjectKey<AActor>, FSGSM_ShipAssembly*> ModuleAssemblies;
+
+	// Unregistering only clears the entry, listeners may unregister brains while the statuses are broadcast.
+	TArray<TWeakObjectPtr<USGSM_PropulsionBrain>> StatusBrains;
+
+};
@@ -6,8 +6,17 @@
 #include "ISGSM_Rocket.h"
 #include "Components/ActorComponent.h"
 #include "SGSM_Utils.h"
+#include "SGSM_PropulsionState.h"
+#include "SGSM_ShipClassDefinition.h"
 #include "SGSM_RocketComponent.generated.h"
 
+class USGSM_PropulsionSubsystem;
+struct FSGSM_ShipAssembly;
+class USGSM_RocketComponent;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FSGSM_OnRocketAttachmentChanged, USGSM_RocketComponent*);
+DECLARE_MULTICAST_DELEGATE_OneParam(FSGSM_OnRocketEfficiencyChanged, USGSM_RocketComponent*);
+
 UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class SPACEGAMESHIPMOVEMENT_API USGSM_RocketComponent : public USceneComponent
 {
@@ -20,7 +29,7 @@ public:
 protected:
 
 	virtual void BeginPlay() override;
-	virtual void AsyncPhysicsTickComponent(float DeltaTime, float SimTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual void OnAttachmentChanged() override;
 
@@ -32,6 +41,34 @@ public:
 	void TickThrust(const double InScale);
 	void EndThrust();
 
+	/** Moves this rocket to the assembly of the ship it is currently attached to and refreshes its cached mount data. */
+	void RefreshAssembly();
+
+	/** Ship assembly this rocket is part of, nullptr outside of game worlds. */
+	const FSGSM_ShipAssembly* GetAssembly() const { return Assembly; }
+
+	/** Same as TickThrust for callers that already computed the world space thrust vector. */
+	void TickThrustVector(const FVector& InThrustVector);
+
+	/** Broadcast whenever this rocket is attached to a different parent, mount-dependent caches should be rebuilt. */
+	FSGSM_OnRocketAttachmentChanged OnRocketAttachmentChanged;
+
+	/** Broadcast by NotifyEfficiencyChanged when the cached efficiency multiplier changed. */
+	FSGSM_OnRocketEfficiencyChanged OnRocketEfficiencyChanged;
+
+	/*
+	 * Implementers of ISGSM_Rocket call this whenever their efficiency changes.
+	 * Re-samples the interface immediately and lets listeners such as the propulsion brain refresh their caches.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SGSM Rocket Component")
+	void NotifyEfficiencyChanged();
+
+	/*
+	 * Native implementers are called through the virtual directly, Blueprint implementers are served from a cache that is
+	 * refreshed by NotifyEfficiencyChanged and, if enabled, at most once per frame.
+	 */
+	double GetEfficiencyMultiplier() const;
+
 	FVector GetMaxThrustVector() const;
 	bool IsRocketThrusting() const;
 
@@ -47,15 +84,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rocket Component")
 	void SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications);
 
-protected:
-
-	//Physics
-	void PhysicsTickThrust(float DeltaTime) const;
+	/** Takes the rocket specifications of a ship class, only the max thrust along this rocket's heading is kept. */
+	void SetShipClassData(const FSGSM_ShipClassData& InShipClassData);
 
 private:
 
 	UStaticMeshComponent* GetRootMesh() const;
 
+	/** (Re)registers this rocket with the batched physics step against the body it currently pushes. */
+	void RegisterRocket();
+	void UnregisterRocket();
+
+	/** Sends a snapshot of the current thrust to the batched physics step. */
+	void PushThrust() const;
+
+	FVector GetMountOffset() const;
+
+	void SetMaxLinearThrust(double InLinearThrustKiloNewtons, const FSGSM_DirectionMultipliers& InBoostMultiplier);
+
 	UPROPERTY(VisibleAnywhere, Category = "Rocket Component", Meta = (DisplayName = "Max Linear Thrust (kN)", ToolTip = "Max linear thrust in mega newtons, used to calculate linear acceleration."))
 	float MaxLinearKiloNewtons = 0;
 
@@ -64,9 +110,28 @@ private:
 
 	FRocketInput RocketInput;
 
+	UPROPERTY(EditAnywhere, Category = "Rocket Component", Meta = (ToolTip = "Re-sample Blueprint rocket interfaces once per frame, for implementers that do not call NotifyEfficiencyChanged. The brain's cached max thrust still only follows notifications."))
+	bool bSampleEfficiencyEveryFrame = false;
+
+	double SampleEfficiencyMultiplier() const;
+
+	mutable double CachedEfficiencyMultiplier = 1.0;
+	mutable uint64 EfficiencySampleFrame = MAX_uint64;
+
+	// Multiplier listeners were last told about, kept apart from the per-frame cache so sampling cannot hide a change.
+	double NotifiedEfficiencyMultiplier = 1.0;
+
 	UPROPERTY(Transient)
 	UPrimitiveComponent* PrimitiveComponent = nullptr;
 
+	UPROPERTY(Transient)
+	USGSM_PropulsionSubsystem* PropulsionSubsystem = nullptr;
+
+	FSGSM_RocketHandle RocketHandle;
+
+	FSGSM_ShipAssembly* Assembly = nullptr;
+
+	// Requested thrust, the applied thrust is read back from the physics step output.
 	FVector CurrentThrustVector = FVector::ZeroVector;
 
 };
@@ -0,0 +1,89 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGSM_Utils.h"
+
+/*
+ * Structure-of-arrays cache of the rocket mounts of one ship, in ship-local space.
+ * Rebuilt only when the set of rockets, their specifications or their attachment changes, so per-frame boost evaluation
+ * runs over contiguous data without touching component transforms or the rocket interface.
+ */
+struct FSGSM_RocketLayout
+{
+	// Index into the owning brain's Rockets array.
+	TArray<int32> RocketIndex;
+
+	TArray<FVector> LocalForward;
+	TArray<FVector> LocalRight;
+	TArray<FVector> MountOffset;
+
+	// Centinewtons.
+	TArray<double> MaxThrust;
+
+	int32 Num() const { return RocketIndex.Num(); }
+
+	void Reset(int32 InExpectedNum = 0)
+	{
+		RocketIndex.Reset(InExpectedNum);
+		LocalForward.Reset(InExpectedNum);
+		LocalRight.Reset(InExpectedNum);
+		MountOffset.Reset(InExpectedNum);
+		MaxThrust.Reset(InExpectedNum);
+	}
+
+	void Add(int32 InRocketIndex, const FTransform& InLocalTransform, double InMaxThrust)
+	{
+		RocketIndex.Add(InRocketIndex);
+		LocalForward.Add(InLocalTransform.GetUnitAxis(EAxis::X));
+		LocalRight.Add(InLocalTransform.GetUnitAxis(EAxis::Y));
+		MountOffset.Add(InLocalTransform.GetLocation());
+		MaxThrust.Add(InMaxThrust);
+	}
+
+	void Set(int32 InEntry, const FTransform& InLocalTransform, double InMaxThrust)
+	{
+		LocalForward[InEntry] = InLocalTransform.GetUnitAxis(EAxis::X);
+		LocalRight[InEntry] = InLocalTransform.GetUnitAxis(EAxis::Y);
+		MountOffset[InEntry] = InLocalTransform.GetLocation();
+		MaxThrust[InEntry] = InMaxThrust;
+	}
+
+	/** Moves the last entry into InEntry, matching FSGSM_ThrustAllocator::RemoveRocketAtSwap. */
+	void RemoveAtSwap(int32 InEntry)
+	{
+		RocketIndex.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+		LocalForward.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+		LocalRight.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+		MountOffset.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+		MaxThrust.RemoveAtSwap(InEntry, 1, EAllowShrinking::No);
+	}
+
+	/** Layout entry of a rocket of the owning brain, INDEX_NONE when it has none. */
+	int32 Find(int32 InRocketIndex) const
+	{
+		return RocketIndex.Find(InRocketIndex);
+	}
+
+	/*
+	 * Engagement in [0, 1] of every rocket when thrusting along InLocalDirection,
+	 * projecting the direction onto the segment between the rocket's forward and its side facing away from the turn.
+	 */
+	void CalculateEngagementValues(const FVector& InLocalDirection, TArray<double>& OutValues) const
+	{
+		const int32 NumRockets = Num();
+		OutValues.SetNumUninitialized(NumRockets, EAllowShrinking::No);
+
+		const FVector* const Forwards = LocalForward.GetData();
+		const FVector* const Rights = LocalRight.GetData();
+		double* const Values = OutValues.GetData();
+
+		const SGSM_PropulsionMath::FVec3 Direction = SGSM_PropulsionMath::ToMath(InLocalDirection);
+
+		for (int32 Index = 0; Index < NumRockets; ++Index)
+		{
+			Values[Index] = SGSM_PropulsionMath::GetRocketEngagement(Direction, SGSM_PropulsionMath::ToMath(Forwards[Index]), SGSM_PropulsionMath::ToMath(Rights[Index]));
+		}
+	}
+};
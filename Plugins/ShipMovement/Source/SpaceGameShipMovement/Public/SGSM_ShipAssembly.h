@@ -0,0 +1,45 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AActor;
+class UPrimitiveComponent;
+class UStaticMeshComponent;
+class USGSM_PropulsionBrain;
+class USGSM_RocketComponent;
+
+/*
+ * Assembly graph of one modular ship, keyed by its attachment root actor.
+ * Tracks the physics root, root mesh and brain of the ship and every rocket on it grouped by the module actor carrying it,
+ * the root actor being a module of itself. Maintained incrementally by USGSM_PropulsionSubsystem as rockets and modules attach and detach.
+ */
+struct FSGSM_ShipAssembly
+{
+	TObjectKey<AActor> RootKey;
+	TWeakObjectPtr<AActor> RootActor;
+	TWeakObjectPtr<UPrimitiveComponent> PhysicsRoot;
+	TWeakObjectPtr<UStaticMeshComponent> RootMesh;
+	TWeakObjectPtr<USGSM_PropulsionBrain> Brain;
+
+	TMap<TObjectKey<AActor>, TArray<TWeakObjectPtr<USGSM_RocketComponent>>> ModuleRockets;
+
+	bool IsEmpty() const { return !Brain.IsValid() && ModuleRockets.IsEmpty(); }
+
+	template <typename FunctionType>
+	void ForEachRocket(FunctionType&& Function) const
+	{
+		for (const TPair<TObjectKey<AActor>, TArray<TWeakObjectPtr<USGSM_RocketComponent>>>& Module : ModuleRockets)
+		{
+			for (const TWeakObjectPtr<USGSM_RocketComponent>& Rocket : Module.Value)
+			{
+				if (USGSM_RocketComponent* const RocketComponent = Rocket.Get())
+				{
+					Function(RocketComponent);
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,123 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SGSM_Utils.h"
+#include "SGSM_ShipClassDefinition.generated.h"
+
+/*
+ * Runtime form of the thruster and rocket specifications of a ship class, with the direction maps compiled to fixed tables.
+ * Immutable once built and shared by pointer between every ship of the class, only ships with overrides get their own copy.
+ */
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_ShipClassData
+{
+	// Thrusters
+	double MaxLinearKiloNewtons = 0.0;
+	double MaxYawKiloNewtons = 0.0;
+	double MaxRotationDegPerSec = 0.0;
+
+	FSGSM_DirectionMultipliers ThrustMultiplier;
+	FSGSM_DirectionMultipliers BoostMultiplier;
+
+	FSGSM_ThrustEnvelope ThrustEnvelope;
+
+	// Rockets, the max thrust of each rocket is scaled by its own mount heading.
+	double RocketLinearThrustKiloNewtons = 0.0;
+	FSGSM_DirectionMultipliers RocketBoostMultiplier;
+
+	static TSharedRef<const FSGSM_ShipClassData> Make(const FThrustersSpecifications& InThrusterSpecifications, const FRocketSpecifications& InRocketSpecifications);
+
+	/** All zero, used by components until they are handed the data of their class. */
+	static const FSGSM_ShipClassData Empty;
+
+	void SetThrusterSpecifications(const FThrustersSpecifications& InThrusterSpecifications);
+	void SetRocketSpecifications(const FRocketSpecifications& InRocketSpecifications);
+
+	/** Call after changing the max linear thrust or the thrust multipliers directly. */
+	void RebuildThrustEnvelope();
+};
+
+/*
+ * Sparse per-instance overrides on top of a ship class, a ship without any override shares the class data as is.
+ */
+USTRUCT(BlueprintType)
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_ShipClassOverrides
+{
+	GENERATED_BODY()
+
+	FSGSM_ShipClassOverrides()
+		: bOverride_LinearThrustKiloNewtons(false)
+		, bOverride_TorqueKiloNewtons(false)
+		, bOverride_MaxAngularVelocity(false)
+		, bOverride_RocketLinearThrustKiloNewtons(false)
+	{
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (InlineEditConditionToggle))
+	uint8 bOverride_LinearThrustKiloNewtons : 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (InlineEditConditionToggle))
+	uint8 bOverride_TorqueKiloNewtons : 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (InlineEditConditionToggle))
+	uint8 bOverride_MaxAngularVelocity : 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (InlineEditConditionToggle))
+	uint8 bOverride_RocketLinearThrustKiloNewtons : 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (EditCondition = "bOverride_LinearThrustKiloNewtons", DisplayName = "Linear Thrust (kN)"))
+	double LinearThrustKiloNewtons = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (EditCondition = "bOverride_TorqueKiloNewtons", DisplayName = "Torque (kNm)"))
+	double TorqueKiloNewtons = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (EditCondition = "bOverride_MaxAngularVelocity", Units = "DegreesPerSecond", DisplayName = "Max Angular Velocity (deg/s)"))
+	double MaxAngularVelocity = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overrides", Meta = (EditCondition = "bOverride_RocketLinearThrustKiloNewtons", DisplayName = "Max Rocket Engine Thrust (kN)"))
+	double RocketLinearThrustKiloNewtons = 0;
+
+	bool HasAnyOverride() const;
+
+	/** Returns InClassData itself when nothing is overridden, otherwise an overridden copy of it. */
+	TSharedRef<const FSGSM_ShipClassData> Apply(const TSharedRef<const FSGSM_ShipClassData>& InClassData) const;
+};
+
+/*
+ * Thruster and rocket specifications shared by every ship of a class.
+ * Ships reference it softly from their propulsion brain and receive the baked class data once it is loaded.
+ */
+UCLASS(BlueprintType)
+class SPACEGAMESHIPMOVEMENT_API USGSM_ShipClassDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Baked form of the specifications, the same pointer for every caller until the asset is edited. */
+	TSharedRef<const FSGSM_ShipClassData> GetClassData() const;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ship Class - Thrusters")
+	FThrustersSpecifications ThrusterSpecs;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ship Class - Rockets")
+	FRocketSpecifications RocketSpecs;
+
+private:
+
+	void Bake() const;
+
+	mutable TSharedPtr<const FSGSM_ShipClassData> ClassData;
+};
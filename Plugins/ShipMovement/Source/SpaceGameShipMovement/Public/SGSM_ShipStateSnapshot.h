@@ -0,0 +1,120 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "SGSM_ShipStateSnapshot.generated.h"
+
+/*
+ * Full precision propulsion state of a ship as seen by observers: body motion plus the thrust values driving visuals.
+ */
+struct FSGSM_ShipStateSample
+{
+	FVector Location = FVector::ZeroVector;
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	// Degrees and degrees per second.
+	double Yaw = 0.0;
+	double YawRate = 0.0;
+
+	FVector2D LinearThrustNormal = FVector2D::ZeroVector;
+	double YawTorqueNormalized = 0.0;
+	double AverageRocketPower = 0.0;
+
+	// Per-rocket power in [0, 1].
+	TArray<float, TInlineAllocator<8>> RocketPowers;
+};
+
+/*
+ * Quantized ship state, delta-encoded against an acknowledged baseline on the wire.
+ * Location and velocity are fixed point integers, yaw is 16 bit, thrust values are single bytes and rocket powers are
+ * a non-zero bitfield followed by one byte per firing rocket. Changed fields are flagged and sent as zigzag varint deltas.
+ */
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_QuantizedShipState
+{
+	static constexpr double LocationResolution = 2.0;
+	static constexpr double VelocityResolution = 2.0;
+	static constexpr double YawRateResolution = 0.1;
+
+	FIntVector Location = FIntVector::ZeroValue;
+	FIntVector Velocity = FIntVector::ZeroValue;
+	uint16 Yaw = 0;
+	int16 YawRate = 0;
+
+	int8 LinearThrustX = 0;
+	int8 LinearThrustY = 0;
+	int8 YawTorque = 0;
+	uint8 AverageRocketPower = 0;
+
+	TArray<uint8, TInlineAllocator<8>> RocketPowers;
+
+	uint16 Sequence = 0;
+
+	static FSGSM_QuantizedShipState Quantize(const FSGSM_ShipStateSample& InSample);
+	FSGSM_ShipStateSample Dequantize() const;
+
+	/** Same state, ignoring the sequence. */
+	bool HasSameState(const FSGSM_QuantizedShipState& Other) const;
+
+	/** Writes this state, delta-encoded when a baseline the receiver has is given. Leaves this state and the baseline untouched. */
+	void Write(FArchive& Ar, const FSGSM_QuantizedShipState* InBaseline) const;
+
+	/*
+	 * Reads a state written by Write, looking the baseline up by sequence.
+	 * Always consumes the whole record, returns false when the referenced baseline is no longer known.
+	 */
+	bool Read(FArchive& Ar, TFunctionRef<const FSGSM_QuantizedShipState*(uint16)> InFindBaseline);
+};
+
+/*
+ * Replicated ship state, delta-serialized against the last state the receiving connection acknowledged.
+ * Receivers keep a short history of states so they can resolve whichever baseline the sender used.
+ */
+USTRUCT()
+struct SPACEGAMESHIPMOVEMENT_API FSGSM_ReplicatedShipState
+{
+	GENERATED_BODY()
+
+	/** Server. Replaces the state, bumping the sequence only when something changed. */
+	void SetState(const FSGSM_QuantizedShipState& InState);
+
+	const FSGSM_QuantizedShipState& GetState() const { return State; }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	/** Number of received states a receiver keeps to resolve baselines. */
+	static constexpr int32 HistorySize = 32;
+
+	/*
+	 * Server. Writes the state delta-encoded against the baseline the receiver acknowledged.
+	 * Falls back to a full state when more states than the receiver's history holds were sent since that baseline.
+	 * OutNewBaseline receives the state that was written, the baseline of the next write once the receiver acknowledges it.
+	 */
+	void WriteState(FArchive& Ar, const FSGSM_QuantizedShipState* InAckedBaseline, FSGSM_QuantizedShipState& OutNewBaseline) const;
+
+	/*
+	 * Client. Reads a state written by WriteState and adds it to the history.
+	 * A state whose baseline is no longer known is consumed but not applied, bOutApplied tells which.
+	 * Returns false only when the archive is corrupt.
+	 */
+	bool ReceiveState(FArchive& Ar, bool& bOutApplied);
+
+private:
+
+	const FSGSM_QuantizedShipState* FindHistory(uint16 InSequence) const;
+
+	FSGSM_QuantizedShipState State;
+
+	TArray<FSGSM_QuantizedShipState> History;
+	int32 HistoryHead = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSGSM_ReplicatedShipState> : public TStructOpsTypeTraitsBase2<FSGSM_ReplicatedShipState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
@@ -0,0 +1,91 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Uniform grid over the XY plane for neighbor queries between many ships, rebuilt from scratch every frame.
+ * Points are counting-sorted into a fixed number of hashed buckets, so a rebuild is two passes without per-cell allocations and a
+ * query only visits the buckets of the cells its radius overlaps. Cells that share a bucket are told apart by the cell stored
+ * with every entry, so each point is visited once per query.
+ */
+class SPACEGAMESHIPMOVEMENT_API FSGSM_SpatialHash
+{
+public:
+
+	/** InCellSize should be about the largest query radius. */
+	void Build(TConstArrayView<FVector> InPoints, double InCellSize);
+
+	void Reset();
+
+	int32 Num() const { return Points.Num(); }
+
+	/*
+	 * Calls InVisitor with the index and squared distance of every point within InRadius of InLocation, in no particular order.
+	 * The visitor returns false to stop the query early.
+	 */
+	template <typename VisitorType>
+	void Query(const FVector& InLocation, double InRadius, VisitorType&& InVisitor) const
+	{
+		if (Points.IsEmpty())
+		{
+			return;
+		}
+
+		const double RadiusSquared = FMath::Square(InRadius);
+		const FIntPoint MinCell = GetCell(InLocation - FVector(InRadius));
+		const FIntPoint MaxCell = GetCell(InLocation + FVector(InRadius));
+
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+			{
+				const uint32 Bucket = GetBucket(CellX, CellY);
+				for (int32 Entry = BucketStart[Bucket]; Entry < BucketStart[Bucket + 1]; ++Entry)
+				{
+					// Another cell of the range may hash to the same bucket, its points are visited with that cell.
+					if (SortedCells[Entry] != FIntPoint(CellX, CellY))
+					{
+						continue;
+					}
+
+					const int32 PointIndex = SortedIndices[Entry];
+					const double DistanceSquared = FVector::DistSquared2D(Points[PointIndex], InLocation);
+					if (DistanceSquared <= RadiusSquared && !InVisitor(PointIndex, DistanceSquared))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+
+private:
+
+	FIntPoint GetCell(const FVector& InLocation) const
+	{
+		return FIntPoint(FMath::FloorToInt32(InLocation.X * InvCellSize), FMath::FloorToInt32(InLocation.Y * InvCellSize));
+	}
+
+	uint32 GetBucket(int32 InCellX, int32 InCellY) const
+	{
+		// Large primes keep neighboring cells apart in the bucket table.
+		return ((static_cast<uint32>(InCellX) * 73856093u) ^ (static_cast<uint32>(InCellY) * 19349663u)) & BucketMask;
+	}
+
+	TArray<FVector> Points;
+	TArray<int32> SortedIndices;
+	TArray<uint32> PointBuckets;
+	TArray<FIntPoint> PointCells;
+
+	// Cell of every sorted entry, next to the indices so the bucket scan does not touch the points.
+	TArray<FIntPoint> SortedCells;
+
+	// Prefix sums, the points of bucket B are SortedIndices[BucketStart[B], BucketStart[B + 1]).
+	TArray<int32> BucketStart;
+	TArray<int32> BucketCursors;
+	uint32 BucketMask = 0;
+
+	double InvCellSize = 1.0;
+};
@@ -0,0 +1,49 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_STATS_GROUP(TEXT("ShipMovement"), STATGROUP_ShipMovement, STATCAT_Advanced);
+
+// Physics thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Propulsion Step"), STAT_SGSM_PropulsionStep, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Step Ship"), STAT_SGSM_StepShip, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Linear Thrust"), STAT_SGSM_PhysicsTickLinearThrust, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Linear Brake"), STAT_SGSM_PhysicsTickLinearBrake, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Angular Thrust"), STAT_SGSM_PhysicsTickAngularThrust, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Angular Brake"), STAT_SGSM_PhysicsTickAngularBrake, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Screen Relative Angular Thrust"), STAT_SGSM_PhysicsTickScreenRelativeAngularThrust, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysicsTick Rocket Thrust"), STAT_SGSM_PhysicsTickRocketThrust, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+
+// Game thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Brain Tick Boosting"), STAT_SGSM_TickBoosting, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Propulsion Status"), STAT_SGSM_PropulsionStatus, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+
+// Mass
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mass Propulsion"), STAT_SGSM_MassPropulsion, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mass Ship Conversion"), STAT_SGSM_MassConversion, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Mass Ships"), STAT_SGSM_MassShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+
+// Fleets
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fleet Steering"), STAT_SGSM_FleetSteering, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Fleet Ships"), STAT_SGSM_FleetShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+
+// Counters, set once per physics step
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Ships"), STAT_SGSM_ActiveShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Mid LOD Ships"), STAT_SGSM_MidShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Far LOD Ships"), STAT_SGSM_FarShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Dormant Ships"), STAT_SGSM_DormantShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Braking Ships"), STAT_SGSM_BrakingShips, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Firing Rockets"), STAT_SGSM_FiringRockets, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency (Physics Frames)"), STAT_SGSM_InputLatencyFrames, STATGROUP_ShipMovement, SPACEGAMESHIPMOVEMENT_API);
+
+/*
+ * Cycle counter that also shows up as a named CPU scope in Unreal Insights.
+ * Both halves compile out when stats and CPU tracing are disabled.
+ */
+#define SGSM_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
@@ -0,0 +1,67 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FSGSM_RocketLayout;
+
+/*
+ * Control allocation for an arbitrary rocket layout.
+ * Keeps the effectiveness matrix of the layout (ship-local X/Y force and yaw torque per unit throttle of every rocket) with its 3x3
+ * Gram matrix and the damped inverse of that, so allocating a desired wrench is one 3x3 solve plus one 3-vector dot product per rocket.
+ * Changing a single rocket only updates its column and re-inverts the 3x3, allocation itself never touches components.
+ */
+class SPACEGAMESHIPMOVEMENT_API FSGSM_ThrustAllocator
+{
+public:
+
+	void Build(const FSGSM_RocketLayout& InLayout);
+	void Reset();
+
+	/** Takes the layout entry InEntry, just added as the last entry of the layout. */
+	void AddRocket(const FSGSM_RocketLayout& InLayout, int32 InEntry);
+
+	/** Refreshes the column of layout entry InEntry after its mount or max thrust changed. */
+	void UpdateRocket(const FSGSM_RocketLayout& InLayout, int32 InEntry);
+
+	/** Drops the column of layout entry InEntry, moving the last one into its place like FSGSM_RocketLayout::RemoveAtSwap. */
+	void RemoveRocketAtSwap(int32 InEntry);
+
+	bool IsValid() const { return bHasInverse && !Columns.IsEmpty(); }
+	int32 Num() const { return Columns.Num(); }
+
+	/*
+	 * Throttles in [0, 1] that best produce InLocalForce (centinewtons) and InYawTorque (centinewton centimeters) in ship space.
+	 * Rockets cannot pull, negative throttles of the unconstrained solution are clamped to zero.
+	 */
+	void Allocate(const FVector& InLocalForce, double InYawTorque, TArray<double>& OutThrottles) const;
+
+	/*
+	 * Throttles pushing along InLocalDirection without yaw, scaled so InScale of 1 drives the most loaded rocket at full throttle.
+	 */
+	void AllocateDirection(const FVector& InLocalDirection, double InScale, TArray<double>& OutThrottles) const;
+
+private:
+
+	static FVector MakeColumn(const FSGSM_RocketLayout& InLayout, int32 InEntry);
+
+	void AddToGram(const FVector& InColumn, double InSign);
+
+	/** Inverts the damped Gram matrix, returns false when the layout has no authority left. */
+	bool UpdateInverse();
+
+	/** Inverse * InWrench, throttle i of the unconstrained solution is the dot product of column i with it. */
+	FVector Solve(const FVector& InWrench) const;
+
+	// Columns of the effectiveness matrix B, one per layout entry, as (Fx, Fy, Mz).
+	TArray<FVector> Columns;
+
+	// B * B^T, undamped, and the inverse of its damped form.
+	double Gram[3][3] = {};
+	double Inverse[3][3] = {};
+	bool bHasInverse = false;
+
+	// Relative Tikhonov damping, keeps layouts without yaw or lateral authority invertible.
+	static constexpr double Damping = 1e-6;
+};
@@ -5,8 +5,12 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "SGSM_Utils.h"
+#include "SGSM_PropulsionState.h"
+#include "SGSM_ShipClassDefinition.h"
 #include "SGSM_ThrustersComponent.generated.h"
 
+class USGSM_PropulsionSubsystem;
+
 UCLASS( ClassGroup=(Custom), Meta=(BlueprintSpawnableComponent))
 class SPACEGAMESHIPMOVEMENT_API USGSM_ThrustersComponent : public UActorComponent
 {
@@ -16,11 +20,10 @@ public:
 	
 	USGSM_ThrustersComponent(const FObjectInitializer& ObjectInitializer);
 
-	virtual void AsyncPhysicsTickComponent(float DeltaTime, float SimTime) override;
-
 protected:
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 
@@ -31,6 +34,9 @@ public:
 	bool IsBoosting() const;
 	void SetBoostAmount(float Value);
 
+	/** Boost amount in use, 0 when not boosting. */
+	double GetBoostAmount() const { return bBoosting ? BoostPercent : 0.0; }
+
 	void ToggleAltTurning();
 	void SetAlternativeTurning(bool bIsEnabled);
 
@@ -70,6 +76,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Thrusters Component")
 	FVector GetMaxThrustOutput(const FVector& InDirection) const;
 
+	/** Max force along a ship-local direction at the current boost state, read from the thrust envelope. */
+	UFUNCTION(BlueprintCallable, Category = "Thrusters Component")
+	FVector GetMaxLocalThrustOutput(const FVector& InLocalDirection) const;
+
+	const FSGSM_ThrustEnvelope& GetThrustEnvelope() const { return GetShipClassData().ThrustEnvelope; }
+
 	UFUNCTION(BlueprintCallable, Category = "Thrusters Component")
 	double GetMaxLinearCentinewtons() const;
 
@@ -79,25 +91,32 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Thrusters Component")
 	double GetCurrentYawTorqueNormalized() const;
 
+	/** Bakes specifications for this ship alone, ships of a class should share its data through SetShipClassData instead. */
 	UFUNCTION(BlueprintCallable, Category = "Thrusters Component")
 	void SetThrusterSpecifications(const FThrustersSpecifications& InThrusterSpecifications);
 
-	FThrusterInput GetThrusterInput() const { return ThrusterInput; }
+	/** Switches to the shared data of a ship class, nothing is copied but the pointer. */
+	void SetShipClassData(const TSharedRef<const FSGSM_ShipClassData>& InShipClassData);
 
-protected:
+	const FSGSM_ShipClassData& GetShipClassData() const { return ShipClassData ? *ShipClassData : FSGSM_ShipClassData::Empty; }
 
-	// Physics
-	void PhysicsTickLinearThrust(float DeltaTime);
-	void PhysicsTickLinearBrake(float DeltaTime);
+	FThrusterInput GetThrusterInput() const { return ThrusterInput; }
 
-	void PhysicsTickAngularThrust(float DeltaTime);
-	void PhysicsTickAngularBrake(float DeltaTime);
+	/** Specifications as used by the batched physics step and by Mass ships of this class. */
+	FSGSM_ThrusterSpecs BuildSpecs() const;
 
-	void PhysicsTickAltAngularThrust(float DeltaTime);
-	void PhysicsTickScreenRelativeAngularThrust(float DeltaTime);
 private:
 
-	FVector GetEngagementVector(const FVector& InDirection, const TMap<EDirection, double>& InDirectionMultiplier) const;
+	/** Sends a snapshot of the current input to the batched physics step. */
+	void PushInput() const;
+
+	/** Copies the current specifications to the batched physics step. */
+	void PushSpecifications() const;
+
+	/** Latest output published by the physics step. */
+	FSGSM_ShipOutputSnapshot ReadOutput() const;
+
+	FVector GetEngagementVector(const FVector& InDirection, const FSGSM_DirectionMultipliers& InDirectionMultiplier) const;
 
 public:
 
@@ -106,14 +125,8 @@ public:
 
 private:
 
-	UPROPERTY(VisibleAnywhere, Category = "Thrusters Component", Meta = (DisplayName = "Max Linear Thrust (kN)", ToolTip = "Max linear thrust in kilo newtons, used to calculate linear acceleration."))
-	float MaxLinearKiloNewtons = 0;
-
-	UPROPERTY(VisibleAnywhere, Category = "Thrusters Component", Meta = (DisplayName = "Max Angular Velocity (deg/s)", ToolTip = "Max angular velocity in degrees per second, used to clamp angular velocity."))
-	double MaxRotationDegPerSec = 0;
-
-	UPROPERTY(VisibleAnywhere, Category = "Thrusters Component", Meta = (DisplayName = "Max Yaw Torque (kNm)", ToolTip = "Max yaw torque in kilo newton meters, used to calculate angular acceleration - turn rate."))
-	double MaxYawKiloNewtons = 0;
+	// Shared with every ship of the same class, see FSGSM_ShipClassData.
+	TSharedPtr<const FSGSM_ShipClassData> ShipClassData;
 
 	double BoostPercent = 0;
 
@@ -126,17 +139,15 @@ private:
 	UPROPERTY(Transient)
 	UPrimitiveComponent* PrimitiveComponent = nullptr;
 
-	FThrusterInput ThrusterInput{};
+	UPROPERTY(Transient)
+	USGSM_PropulsionSubsystem* PropulsionSubsystem = nullptr;
 
+	FSGSM_ShipHandle ShipHandle;
 
-	FVector PreviousLocationBeforeBraking = FVector::ZeroVector;
-	FVector LinearThrustVector = FVector::ZeroVector;
+	FThrusterInput ThrusterInput{};
 
-	double CurrentYawTorque = 0.0;
 	double MissTolerance = 5.0;
 
-	bool bLinearThrustActive = false;
-	bool bAngularThrustActive = false;
 	bool bBoosting = false;
 
 };
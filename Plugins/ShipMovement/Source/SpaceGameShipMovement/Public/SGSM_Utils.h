@@ -4,8 +4,17 @@
 
 #include "CoreMinimal.h"
 #include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "SGSM_PropulsionMath.h"
 #include "SGSM_Utils.generated.h"
 
+/* Conversions between engine types and the plain types of the propulsion math core, free once inlined. */
+namespace SGSM_PropulsionMath
+{
+	inline FVec3 ToMath(const FVector& InVector) { return { InVector.X, InVector.Y, InVector.Z }; }
+	inline FQuat4 ToMath(const FQuat& InQuat) { return { InQuat.X, InQuat.Y, InQuat.Z, InQuat.W }; }
+	inline FVector ToVector(const FVec3& InVector) { return FVector(InVector.X, InVector.Y, InVector.Z); }
+}
+
 UENUM()
 enum class EDirection : uint8
 {
@@ -53,6 +62,107 @@ struct FRocketSpecifications
 	TMap<EDirection, double> BoostMultiplier;
 };
 
+/*
+ * Fixed-size multiplier table indexed by EDirection, compiled from the designer-facing TMap<EDirection, double>.
+ * Directions missing from the map keep a multiplier of 1, an empty map disables the engagement entirely.
+ */
+struct FSGSM_DirectionMultipliers
+{
+	static constexpr int32 NumDirections = static_cast<int32>(EDirection::Count);
+
+	FSGSM_DirectionMultipliers()
+	{
+		for (double& Value : Values)
+		{
+			Value = 1.0;
+		}
+	}
+
+	static FSGSM_DirectionMultipliers Compile(const TMap<EDirection, double>& InDirectionMultiplier)
+	{
+		FSGSM_DirectionMultipliers Result;
+		for (const TPair<EDirection, double>& Pair : InDirectionMultiplier)
+		{
+			if (Pair.Key < EDirection::Count)
+			{
+				Result.Values[static_cast<int32>(Pair.Key)] = Pair.Value;
+			}
+		}
+
+		Result.Scale.Front = Result[EDirection::Front];
+		Result.Scale.Back = Result[EDirection::Back];
+		Result.Scale.Left = Result[EDirection::Left];
+		Result.Scale.Right = Result[EDirection::Right];
+		Result.Scale.bEnabled = !InDirectionMultiplier.IsEmpty();
+		return Result;
+	}
+
+	double operator[](EDirection InDirection) const { return Values[static_cast<int32>(InDirection)]; }
+
+	/** Per-axis multiplier for a direction already in ship-local space, Z is never scaled. Zero when disabled. */
+	FVector GetLocalAxisScale(const FVector& InLocalDirection) const
+	{
+		return SGSM_PropulsionMath::ToVector(SGSM_PropulsionMath::GetLocalAxisScale(Scale, SGSM_PropulsionMath::ToMath(InLocalDirection)));
+	}
+
+	const SGSM_PropulsionMath::FDirectionScale& GetScale() const { return Scale; }
+
+	bool IsEnabled() const { return Scale.bEnabled; }
+
+private:
+
+	double Values[NumDirections];
+	SGSM_PropulsionMath::FDirectionScale Scale;
+};
+
+/*
+ * Local-space thrust envelope of a ship, the max force in centinewtons along each of the +-X/+-Y/+-Z axes with and without boost.
+ * Built once from the specifications, after that the max force in any local direction is a per-axis table lookup.
+ */
+struct FSGSM_ThrustEnvelope
+{
+	enum EAxis : uint8
+	{
+		PosX,
+		NegX,
+		PosY,
+		NegY,
+		PosZ,
+		NegZ,
+		NumAxes
+	};
+
+	static FSGSM_ThrustEnvelope Build(double InMaxLinearCentinewtons, const FSGSM_DirectionMultipliers& InThrustMultiplier, const FSGSM_DirectionMultipliers& InBoostMultiplier)
+	{
+		FSGSM_ThrustEnvelope Result;
+		Result.Envelope = SGSM_PropulsionMath::FThrustEnvelope::Build(InMaxLinearCentinewtons, InThrustMultiplier.GetScale(), InBoostMultiplier.GetScale());
+		return Result;
+	}
+
+	/** Max force along one axis, InBoostScale is the current boost amount or 0 when not boosting. */
+	double GetMaxForce(EAxis InAxis, double InBoostScale) const
+	{
+		return Envelope.GetMaxForce(static_cast<SGSM_PropulsionMath::FThrustEnvelope::EAxis>(InAxis), InBoostScale);
+	}
+
+	/** Force produced when thrusting along InLocalDirection, interpolated per axis from the envelope. */
+	FVector GetForce(const FVector& InLocalDirection, double InBoostScale) const
+	{
+		return SGSM_PropulsionMath::ToVector(Envelope.GetForce(SGSM_PropulsionMath::ToMath(InLocalDirection), InBoostScale));
+	}
+
+	static FVector GetAxisDirection(EAxis InAxis)
+	{
+		return SGSM_PropulsionMath::ToVector(SGSM_PropulsionMath::FThrustEnvelope::GetAxisDirection(static_cast<SGSM_PropulsionMath::FThrustEnvelope::EAxis>(InAxis)));
+	}
+
+	const SGSM_PropulsionMath::FThrustEnvelope& GetMath() const { return Envelope; }
+
+private:
+
+	SGSM_PropulsionMath::FThrustEnvelope Envelope;
+};
+
 USTRUCT()
 struct FThrusterInput
 {
@@ -62,9 +172,6 @@ struct FThrusterInput
 	bool bLinearBrake = false;
 	bool bAngularBrake = false;
 	bool bAlternativeTurning = false;
-
-	TMap<EDirection, double> ThrustMultiplier;
-	TMap<EDirection, double> BoostMultiplier;
 };
 
 USTRUCT()
@@ -72,10 +179,6 @@ struct FRocketInput
 {
 	GENERATED_BODY()
 	bool bRocketThrusting = false;
-
-	FVector ThrustMultiplier;
-
-	TMap<EDirection, double> BoostMultiplier;
 };
 
 class SPACEGAMESHIPMOVEMENT_API SGSM_Utils
@@ -92,8 +195,17 @@ public:
 	static int32 GetCentinewtonsPerKiloNewton() { return CentinewtonsPerKiloNewton; }
 	static int32 GetCentinewtonsPerMegaNewton() { return CentinewtonsPerMegaNewton; }
 
+	static FVector GetThrustEngagementVector(const FVector& ForwardVector, const FVector& InDirection, const FSGSM_DirectionMultipliers& InDirectionMultiplier);
 	static FVector GetThrustEngagementVector(const FVector& ForwardVector, const FVector& InDirection, const TMap<EDirection, double>& InDirectionMultiplier);
 
+	/*
+	 * Fused thrust and boost engagement for a body rotation, as used by the physics step.
+	 * Equivalent to the thrust engagement plus the boost engagement scaled by InBoostScale, with a single rotation into local space and back.
+	 */
+	static FVector GetThrustEngagementVector(const FQuat& InBodyRotation, const FVector& InDirection, const FSGSM_DirectionMultipliers& InThrustMultiplier, const FSGSM_DirectionMultipliers& InBoostMultiplier, double InBoostScale);
+
+	/** Demo ship pawn of the plugin, the default ship class of the benchmark commandlet and the traffic console command. */
+	static const TCHAR* const DemoShipClassPath;
 
 protected:
 
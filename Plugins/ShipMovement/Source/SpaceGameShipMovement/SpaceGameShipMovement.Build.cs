@@ -28,6 +28,8 @@ public class SpaceGameShipMovement : ModuleRules
 				"Core",
 				"CoreUObject",
 				"Engine",
+				"MassEntity",
+				"Niagara",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -41,9 +43,12 @@ public class SpaceGameShipMovement : ModuleRules
 				"CommonUI",
 				"EnhancedInput",
 				"InputCore",
+				"MassCommon",
+				"NiagaraCore",
 				"Slate",
 				"SlateCore",
-				"UMG"
+				"UMG",
+				"VectorVM"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
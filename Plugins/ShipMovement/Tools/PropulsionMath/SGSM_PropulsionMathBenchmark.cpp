@@ -0,0 +1,122 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PropulsionMath.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace SGSM_PropulsionMath;
+
+namespace
+{
+	// Keeps results alive so the optimizer cannot drop the measured work.
+	volatile double GSink = 0.0;
+
+	struct FShipSample
+	{
+		FQuat4 Rotation;
+		FVec3 Direction;
+		FVec3 LinearVelocity;
+		double YawRate = 0.0;
+	};
+
+	std::vector<FShipSample> MakeSamples(size_t Num)
+	{
+		std::mt19937 Random(1337);
+		std::uniform_real_distribution<double> Unit(-1.0, 1.0);
+
+		std::vector<FShipSample> Samples(Num);
+		for (FShipSample& Sample : Samples)
+		{
+			const double Yaw = Unit(Random) * Pi;
+			Sample.Rotation = { 0.0, 0.0, std::sin(Yaw * 0.5), std::cos(Yaw * 0.5) };
+			Sample.Direction = SafeNormal2D({ Unit(Random), Unit(Random), 0.0 });
+			Sample.LinearVelocity = { Unit(Random) * 5000.0, Unit(Random) * 5000.0, 0.0 };
+			Sample.YawRate = Unit(Random) * 2.0;
+		}
+		return Samples;
+	}
+
+	template <typename KernelType>
+	void Run(const char* Name, const std::vector<FShipSample>& Samples, int Iterations, KernelType&& Kernel)
+	{
+		double Accumulator = 0.0;
+
+		const auto Start = std::chrono::steady_clock::now();
+		for (int Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (const FShipSample& Sample : Samples)
+			{
+				Accumulator += Kernel(Sample);
+			}
+		}
+		const auto End = std::chrono::steady_clock::now();
+
+		GSink = GSink + Accumulator;
+
+		const double Nanoseconds = std::chrono::duration<double, std::nano>(End - Start).count();
+		const double Calls = static_cast<double>(Samples.size()) * Iterations;
+		std::printf("%-28s %10.2f ns/call %12.0f calls/s\n", Name, Nanoseconds / Calls, Calls / (Nanoseconds * 1.e-9));
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const int Iterations = Argc > 1 ? std::atoi(Argv[1]) : 200;
+	const std::vector<FShipSample> Samples = MakeSamples(4096);
+
+	FDirectionScale Thrust;
+	Thrust.Front = 1.0;
+	Thrust.Back = 0.5;
+	Thrust.Left = 0.4;
+	Thrust.Right = 0.4;
+	Thrust.bEnabled = true;
+
+	FDirectionScale Boost = Thrust;
+	Boost.Back = 0.0;
+
+	const FThrustEnvelope Envelope = FThrustEnvelope::Build(5.e8, Thrust, Boost);
+
+	constexpr double MaxTorque = 2.e8;
+	constexpr double Inertia = 1.e6;
+	constexpr double DeltaTime = 1.0 / 60.0;
+
+	std::printf("%zu samples x %d iterations\n", Samples.size(), Iterations);
+
+	Run("GetThrustEngagement", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		return GetThrustEngagement(Sample.Rotation, Sample.Direction, Thrust, Boost, 0.5).X;
+	});
+
+	Run("FThrustEnvelope::GetForce", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		return Envelope.GetForce(UnrotateVector(Sample.Rotation, Sample.Direction), 0.5).X;
+	});
+
+	Run("GetLinearBrakeForce", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		return GetLinearBrakeForce(Envelope, Sample.Rotation, Sample.LinearVelocity, 0.0).X;
+	});
+
+	Run("GetClampedYawTorque", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		double Torque = 0.0;
+		GetClampedYawTorque(Sample.Direction.X, MaxTorque, 1.0, Inertia, Sample.YawRate, DeltaTime, Torque);
+		return Torque;
+	});
+
+	Run("GetScreenRelativeSteering", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		return GetScreenRelativeSteering(GetForwardVector(Sample.Rotation), Sample.Direction, Sample.YawRate, MaxTorque, Inertia, 0.087, DeltaTime).Torque;
+	});
+
+	Run("GetRocketEngagement", Samples, Iterations, [&](const FShipSample& Sample)
+	{
+		return GetRocketEngagement(Sample.Direction, GetForwardVector(Sample.Rotation), RotateVector(Sample.Rotation, { 0.0, 1.0, 0.0 }));
+	});
+
+	return 0;
+}
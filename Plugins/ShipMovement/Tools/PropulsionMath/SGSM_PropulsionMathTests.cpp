@@ -0,0 +1,218 @@
+// Copyright Distant Light Games, Inc. All Rights Reserved.
+
+#include "SGSM_PropulsionMath.h"
+
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace SGSM_PropulsionMath;
+
+namespace
+{
+	int GNumFailures = 0;
+
+	void Expect(bool bCondition, const char* Expression, const char* File, int Line)
+	{
+		if (!bCondition)
+		{
+			std::printf("%s(%d): expected %s\n", File, Line, Expression);
+			++GNumFailures;
+		}
+	}
+
+	bool IsNear(double A, double B, double Tolerance = 1.e-6)
+	{
+		return std::abs(A - B) <= Tolerance;
+	}
+
+	bool IsNear(const FVec3& A, const FVec3& B, double Tolerance = 1.e-6)
+	{
+		return IsNear(A.X, B.X, Tolerance) && IsNear(A.Y, B.Y, Tolerance) && IsNear(A.Z, B.Z, Tolerance);
+	}
+
+	FQuat4 YawQuat(double YawRad)
+	{
+		return { 0.0, 0.0, std::sin(YawRad * 0.5), std::cos(YawRad * 0.5) };
+	}
+
+	FDirectionScale MakeScale(double Front, double Back, double Left, double Right)
+	{
+		FDirectionScale Scale;
+		Scale.Front = Front;
+		Scale.Back = Back;
+		Scale.Left = Left;
+		Scale.Right = Right;
+		Scale.bEnabled = true;
+		return Scale;
+	}
+}
+
+#define SGSM_EXPECT(Expression) Expect((Expression), #Expression, __FILE__, __LINE__)
+
+static void TestRotation()
+{
+	const FQuat4 Rotation = YawQuat(Pi * 0.5);
+
+	SGSM_EXPECT(IsNear(RotateVector(Rotation, { 1.0, 0.0, 0.0 }), { 0.0, 1.0, 0.0 }));
+	SGSM_EXPECT(IsNear(UnrotateVector(Rotation, RotateVector(Rotation, { 1.0, 2.0, 3.0 })), { 1.0, 2.0, 3.0 }));
+	SGSM_EXPECT(IsNear(GetForwardVector(FQuat4()), { 1.0, 0.0, 0.0 }));
+}
+
+static void TestLocalAxisScale()
+{
+	const FDirectionScale Scale = MakeScale(2.0, 3.0, 4.0, 5.0);
+
+	SGSM_EXPECT(IsNear(GetLocalAxisScale(Scale, { -1.0, -1.0, 0.0 }), { 2.0, 5.0, 1.0 }));
+	SGSM_EXPECT(IsNear(GetLocalAxisScale(Scale, { 1.0, 1.0, 1.0 }), { 3.0, 4.0, 1.0 }));
+	SGSM_EXPECT(IsNear(GetLocalAxisScale(FDirectionScale(), { 1.0, 1.0, 1.0 }), {}));
+}
+
+static void TestThrustEngagement()
+{
+	const FDirectionScale Thrust = MakeScale(1.0, 0.5, 0.25, 0.25);
+	const FDirectionScale Boost = MakeScale(1.0, 0.0, 0.0, 0.0);
+
+	// Local +X picks the Back multiplier, boost only adds on the Front axis.
+	SGSM_EXPECT(IsNear(GetThrustEngagement(FQuat4(), { 1.0, 0.0, 0.0 }, Thrust, Boost, 1.0), { 0.5, 0.0, 0.0 }));
+	SGSM_EXPECT(IsNear(GetThrustEngagement(FQuat4(), { -1.0, 0.0, 0.0 }, Thrust, Boost, 0.5), { -1.5, 0.0, 0.0 }));
+
+	// The same local thrust, with the body turned a quarter.
+	const FQuat4 Rotation = YawQuat(Pi * 0.5);
+	SGSM_EXPECT(IsNear(GetThrustEngagement(Rotation, { 0.0, 1.0, 0.0 }, Thrust, Boost, 1.0), { 0.0, 0.5, 0.0 }));
+
+	SGSM_EXPECT(IsNear(GetThrustEngagement(FQuat4(), { 1.0, 1.0, 0.0 }, FDirectionScale(), FDirectionScale(), 1.0), {}));
+}
+
+static void TestThrustEnvelope()
+{
+	const FDirectionScale Thrust = MakeScale(1.0, 0.5, 0.25, 0.75);
+	const FDirectionScale Boost = MakeScale(2.0, 0.0, 0.0, 0.0);
+	const FThrustEnvelope Envelope = FThrustEnvelope::Build(1000.0, Thrust, Boost);
+
+	// The envelope must agree with the engagement kernel it caches.
+	const FVec3 Directions[] = { { 1.0, 0.0, 0.0 }, { -1.0, 0.0, 0.0 }, { 0.6, -0.8, 0.0 }, { -0.6, 0.8, 0.0 } };
+	for (const FVec3& Direction : Directions)
+	{
+		for (const double BoostAmount : { 0.0, 0.5, 1.0 })
+		{
+			const FVec3 Expected = GetThrustEngagement(FQuat4(), Direction, Thrust, Boost, BoostAmount) * 1000.0;
+			SGSM_EXPECT(IsNear(Envelope.GetForce(Direction, BoostAmount), Expected));
+		}
+	}
+
+	SGSM_EXPECT(IsNear(Envelope.GetMaxForce(FThrustEnvelope::NegX, 1.0), 3000.0));
+	SGSM_EXPECT(IsNear(GetMaxThrustMagnitude(Envelope, FQuat4(), { -0.1, 0.0, 0.0 }, 0.0), 1000.0));
+}
+
+static void TestLinearBrake()
+{
+	const FThrustEnvelope Envelope = FThrustEnvelope::Build(1.e9, MakeScale(1.0, 1.0, 1.0, 1.0), FDirectionScale());
+
+	// Slow body, the stopping force is below the envelope and points against the velocity.
+	const FVec3 Force = GetLinearBrakeForce(Envelope, FQuat4(), { 2.0, 0.0, 0.0 }, 0.0);
+	SGSM_EXPECT(IsNear(Force, { -2.0 * 10.0 * CentinewtonsPerKiloNewton, 0.0, 0.0 }));
+
+	// Fast body, capped by the envelope.
+	const FVec3 Capped = GetLinearBrakeForce(Envelope, FQuat4(), { 0.0, -1.e6, 0.0 }, 0.0);
+	SGSM_EXPECT(IsNear(Capped, { 0.0, 1.e9, 0.0 }, 1.e-3));
+
+	SGSM_EXPECT(IsNear(GetLinearBrakeForce(Envelope, FQuat4(), {}, 0.0), {}));
+}
+
+static void TestClampedYawTorque()
+{
+	constexpr double MaxTorque = 1000.0;
+	constexpr double MaxRate = 1.0;
+	constexpr double Inertia = 10.0;
+	constexpr double DeltaTime = 1.0 / 60.0;
+
+	// Simulating full input never winds the yaw rate past the max.
+	double YawRate = 0.0;
+	for (int Step = 0; Step < 600; ++Step)
+	{
+		double Torque = 0.0;
+		if (GetClampedYawTorque(1.0, MaxTorque, MaxRate, Inertia, YawRate, DeltaTime, Torque))
+		{
+			YawRate += Torque / Inertia * DeltaTime;
+		}
+		SGSM_EXPECT(YawRate <= MaxRate + 1.e-6);
+	}
+	SGSM_EXPECT(IsNear(YawRate, MaxRate, 1.e-3));
+
+	double Torque = 0.0;
+	SGSM_EXPECT(!GetClampedYawTorque(1.0, MaxTorque, MaxRate, Inertia, MaxRate * 2.0, DeltaTime, Torque));
+
+	// No turn input must not produce a non-finite torque.
+	SGSM_EXPECT(GetClampedYawTorque(0.0, MaxTorque, MaxRate, Inertia, MaxRate, DeltaTime, Torque));
+	SGSM_EXPECT(std::isfinite(Torque));
+}
+
+static void TestScreenRelativeSteering()
+{
+	constexpr double MaxTorque = 2000.0;
+	constexpr double Inertia = 1000.0;
+	constexpr double DeltaTime = 1.0 / 60.0;
+	constexpr double MissTolerance = 5.0 * Pi / 180.0;
+
+	// Turn a resting body toward a target a quarter turn away, it should settle on the target.
+	const FVec3 Target{ 0.0, 1.0, 0.0 };
+	double Yaw = 0.0;
+	double YawRate = 0.0;
+
+	for (int Step = 0; Step < 60 * 20; ++Step)
+	{
+		const FSteeringCommand Command = GetScreenRelativeSteering(GetForwardVector(YawQuat(Yaw)), Target, YawRate, MaxTorque, Inertia, MissTolerance, DeltaTime);
+		if (Command.bStopRotation)
+		{
+			YawRate = 0.0;
+		}
+		else if (Command.bApplyTorque)
+		{
+			// The controller works in centinewtons, the same conversion the physics step sees.
+			YawRate += Command.Torque / Inertia * DeltaTime;
+		}
+		Yaw += YawRate * DeltaTime;
+	}
+
+	SGSM_EXPECT(IsNear(Yaw, Pi * 0.5, 0.05));
+
+	const FSteeringCommand Idle = GetScreenRelativeSteering({ 1.0, 0.0, 0.0 }, {}, 0.0, MaxTorque, Inertia, MissTolerance, DeltaTime);
+	SGSM_EXPECT(!Idle.bApplyTorque && !Idle.bStopRotation);
+}
+
+static void TestRocketEngagement()
+{
+	const FVec3 Forward{ 1.0, 0.0, 0.0 };
+	const FVec3 Right{ 0.0, 1.0, 0.0 };
+
+	SGSM_EXPECT(IsNear(GetRocketEngagement(Forward, Forward, Right), 1.0));
+	SGSM_EXPECT(IsNear(GetRocketEngagement(-Forward, Forward, Right), 0.0));
+
+	const double Engagement = GetRocketEngagement({ 0.7071, 0.7071, 0.0 }, Forward, Right);
+	SGSM_EXPECT(Engagement > 0.0 && Engagement < 1.0);
+}
+
+int main()
+{
+	const std::vector<std::pair<const char*, std::function<void()>>> Tests = {
+		{ "Rotation", TestRotation },
+		{ "LocalAxisScale", TestLocalAxisScale },
+		{ "ThrustEngagement", TestThrustEngagement },
+		{ "ThrustEnvelope", TestThrustEnvelope },
+		{ "LinearBrake", TestLinearBrake },
+		{ "ClampedYawTorque", TestClampedYawTorque },
+		{ "ScreenRelativeSteering", TestScreenRelativeSteering },
+		{ "RocketEngagement", TestRocketEngagement },
+	};
+
+	for (const auto& [Name, Test] : Tests)
+	{
+		const int FailuresBefore = GNumFailures;
+		Test();
+		std::printf("[%s] %s\n", GNumFailures == FailuresBefore ? "PASS" : "FAIL", Name);
+	}
+
+	return GNumFailures == 0 ? 0 : 1;
+}